@@ -0,0 +1,668 @@
+/*
+ * Copyright (c) 2014 Matt Hall <mtjhall@alumni.uvic.ca>
+ *
+ * This file is part of MoorDyn.  MoorDyn is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * MoorDyn is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MoorDyn.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// MoorDynBench: standalone benchmark driver for MoorDyn-SYNCOM (the native counterpart of Matlab/template.m).
+// It loads a mooring input file and MaterDef.xml, replays prescribed fairlead motions through the MoorDyn
+// interface and reports the stepping rate, the time spent in each phase (from the Profile solver option)
+// and the peak memory use.  Sweeps over the segment count, the number of lines and dtM are run on modified
+// copies of the input file, written (together with all MoorDyn output) to the MoorDynBench subfolder.
+// MaterDef.xml and waves.txt are copied along from the folder of the input file (if they are there).
+//
+// usage: MoorDynBench [options]
+//   -dir <folder>        working folder holding the input file (default: current folder)
+//   -input <file>        mooring input file, relative to the working folder (default: Mooring/lines.txt)
+//   -motion <profile>    template (ramp to 0.1 and 0.35 MBL, then harmonic cycles, as template.m),
+//                        ramp, hold or harmonic (default: template)
+//   -sigma <s>           target fairlead stress / MBL of a single ramp (default 0.35)
+//   -speed <v>           fairlead speed during ramps (m/s, default 3.5)
+//   -hold <s>            duration of a hold (s, default 10)
+//   -amp <a>             amplitude of the harmonic motion (m, default 1)
+//   -period <T>          period of the harmonic motion (s, default 10)
+//   -cycles <n>          number of harmonic cycles (default 20)
+//   -dt <s>              coupling time step (s, default 0.005)
+//   -tmax <s>            limit on the simulated time of each case (s, default 8000)
+//   -sweep <kind> <list> one case per value of a comma separated list: segs (segments of every line, the
+//                        time step is then picked from the CFL limit), lines (copies of the system spread
+//                        evenly around the platform) or dtM (mooring time step)
+//   -csv <file>          also write one row per case to a CSV file (appended if it exists)
+//   -noprofile           run without the Profile option (no phase times)
+//   -skiptol <tol>       reuse SYNCOM evaluations of segments whose strain changed by less than tol
+//                        (solver option SCskipTol, default: as in the input file)
+
+#include "MoorDyn.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+
+#ifdef _WIN32
+ #include <windows.h>
+ #include <psapi.h>
+ #include <direct.h>
+#else
+ #include <unistd.h>
+ #include <sys/stat.h>
+ #include <sys/resource.h>
+#endif
+
+using namespace std;
+
+const double pi = 3.14159265;
+
+const char* benchDir = "MoorDynBench";		// subfolder for the case input files and their output
+
+// motion segments
+const int RAMP = 0;
+const int HOLD = 1;
+const int HARMONIC = 2;
+
+typedef struct
+{
+	int type;
+	double value;	// target stress / MBL (ramp), duration (hold) or number of cycles (harmonic)
+} MotionPhase;
+
+typedef struct
+{
+	string input;
+	string motion;
+	double sigma;
+	double speed;
+	double hold;
+	double amp;
+	double period;
+	double cycles;
+	double dt;
+	double tmax;
+	string sweep;
+	vector<double> sweepValues;
+	string csv;
+	int profile;
+	double skipTol;		// SCskipTol (< 0 = as in the input file)
+} BenchOptions;
+
+typedef struct
+{
+	string name;
+	int segs;		// segments of every line (0 = as in the input file)
+	int copies;		// number of copies of the mooring system (1 = as in the input file)
+	double dtM;		// mooring time step (0 = as in the input file)
+} BenchCase;
+
+typedef struct
+{
+	int nLines;
+	int nSegs;			// total number of segments
+	long steps;
+	double tSim;
+	double tInit;
+	double tRun;
+	double peakMB;
+	vector<double> prof;	// MoorDyn_GetProfile buffer
+} BenchResult;
+
+
+static double wallTime()
+{
+	return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static vector<string> splitWords(const string& s)
+{
+	vector<string> words;
+	istringstream ss(s);
+	string w;
+	while (ss >> w)  words.push_back(w);
+	return words;
+}
+
+static string joinWords(const vector<string>& words)
+{
+	string s;
+	for (int i=0; i<words.size(); i++)
+		s += (i ? " " : "") + words[i];
+	return s;
+}
+
+static string num2str(double x)
+{
+	ostringstream ss;
+	ss << setprecision(10) << x;
+	return ss.str();
+}
+
+static void makeDir(const char* path)
+{
+#ifdef _WIN32
+	_mkdir(path);
+#else
+	mkdir(path, 0755);
+#endif
+}
+
+// copies a file if it exists
+static void copyFile(const string& from, const string& to)
+{
+	ifstream in(from.c_str(), ios::in | ios::binary);
+	if (!in.is_open())
+		return;
+	ofstream out(to.c_str(), ios::out | ios::binary);
+	out << in.rdbuf();
+}
+
+// resets the peak resident memory where the OS allows it, so that each case reports its own peak
+static void resetPeakMemory()
+{
+#ifdef __linux__
+	FILE* f = fopen("/proc/self/clear_refs", "w");
+	if (f)
+	{
+		fputs("5", f);
+		fclose(f);
+	}
+#endif
+}
+
+// peak resident memory of the process (MB)
+static double peakMemoryMB()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS pmc;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+		return pmc.PeakWorkingSetSize/1048576.0;
+	return 0.0;
+#else
+ #ifdef __linux__
+	ifstream status("/proc/self/status");
+	string line;
+	while (getline(status, line))
+		if (line.compare(0, 6, "VmHWM:") == 0)
+			return atof(line.c_str() + 6)/1024.0;		// kB
+ #endif
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+ #ifdef __APPLE__
+	return usage.ru_maxrss/1048576.0;		// bytes
+ #else
+	return usage.ru_maxrss/1024.0;			// kB
+ #endif
+#endif
+}
+
+
+// write a copy of the input file with the modifications of a case applied
+static int writeCaseInput(const vector<string>& lines, const BenchCase& bc, const BenchOptions& opt, const string& path)
+{
+	vector<string> out;
+	vector< vector<string> > connRows, lineRows;
+	int section = 0;		// 1 = connections, 2 = lines, 3 = options
+	int row = 0;			// line number within the section
+
+	for (int i=0; i<lines.size(); i++)
+	{
+		if (lines[i].find("---") != string::npos)	// header line
+		{
+			// finish the previous section
+			if ((section == 1) && (bc.copies > 1))
+			{
+				// copies of the connections rotated about the platform z axis
+				int nConn = connRows.size();
+				for (int c=1; c<bc.copies; c++)
+				{
+					double a = 2.0*pi*c/bc.copies;
+					for (int j=0; j<nConn; j++)
+					{
+						vector<string> e = connRows[j];
+						double x = atof(e[2].c_str());
+						double y = atof(e[3].c_str());
+						e[0] = num2str(atoi(e[0].c_str()) + c*nConn);
+						e[2] = num2str(x*cos(a) - y*sin(a));
+						e[3] = num2str(x*sin(a) + y*cos(a));
+						out.push_back(joinWords(e));
+					}
+				}
+			}
+			else if ((section == 2) && (bc.copies > 1))
+			{
+				int nConn = connRows.size();
+				int nLine = lineRows.size();
+				for (int c=1; c<bc.copies; c++)
+				{
+					for (int j=0; j<nLine; j++)
+					{
+						vector<string> e = lineRows[j];
+						e[0] = num2str(atoi(e[0].c_str()) + c*nLine);
+						e[4] = num2str(atoi(e[4].c_str()) + c*nConn);
+						e[5] = num2str(atoi(e[5].c_str()) + c*nConn);
+						out.push_back(joinWords(e));
+					}
+				}
+			}
+			else if (section == 3)
+			{
+				// options added at the end of the section override those of the input file
+				if (bc.dtM > 0.0)   out.push_back(num2str(bc.dtM) + " dtM");
+				if (bc.segs > 0)    out.push_back("1 dtMauto");
+				if (opt.profile)    out.push_back("1 Profile");
+				if (opt.skipTol >= 0.0)  out.push_back(num2str(opt.skipTol) + " SCskipTol");
+			}
+
+			if ((lines[i].find("CONNECTION PROPERTIES") != string::npos) || (lines[i].find("NODE PROPERTIES") != string::npos))
+				section = 1;
+			else if (lines[i].find("LINE PROPERTIES") != string::npos)
+				section = 2;
+			else if (lines[i].find("SOLVER OPTIONS") != string::npos)
+				section = 3;
+			else
+				section = 0;
+			row = 0;
+			out.push_back(lines[i]);
+			continue;
+		}
+
+		row++;
+		vector<string> e = splitWords(lines[i]);
+		if ((section == 1) && (row > 2) && (e.size() >= 10))
+			connRows.push_back(e);
+		else if ((section == 2) && (row > 2) && (e.size() >= 7))
+		{
+			if (bc.segs > 0)
+				e[3] = num2str(bc.segs);
+			lineRows.push_back(e);
+			out.push_back(joinWords(e));
+			continue;
+		}
+		out.push_back(lines[i]);
+	}
+
+	ofstream f(path.c_str());
+	if (!f.is_open())
+	{
+		cout << "   Error: unable to write " << path << endl;
+		return -1;
+	}
+	for (int i=0; i<out.size(); i++)  f << out[i] << "\n";
+	return 0;
+}
+
+
+// fairlead stress / MBL of the last segment of line 1 (0 for non-SYNCOM lines)
+static double fairleadStress(MoorDynHandle h, vector<double>& buf)
+{
+	int N = MoorDyn_GetLineN(h, 1);
+	if (N <= 0)  return 0.0;
+	buf.resize(N);
+	MoorDyn_GetLineData(h, 1, MD_SC_STRESS, &buf[0]);
+	return buf[N-1];
+}
+
+
+// run one case: initialize, replay the motion phases and collect the timings
+static int runCase(const string& input, const vector<MotionPhase>& phases, const BenchOptions& opt, BenchResult& res)
+{
+	double X[6] = {0.0}, XD[6] = {0.0}, F[6];
+	double dt = opt.dt;
+	double t = 0.0;
+	vector<double> buf;
+
+	resetPeakMemory();
+	MoorDynHandle h = MoorDyn_Create(input.c_str());
+
+	double t0 = wallTime();
+	if (MoorDyn_Init(h, X, XD))
+	{
+		MoorDyn_Destroy(h);
+		return -1;
+	}
+	double t1 = wallTime();
+
+	res.nLines = 0;
+	while (MoorDyn_GetLineN(h, res.nLines+1) > 0)  res.nLines++;
+	res.nSegs = MoorDyn_GetLineN(h, 0);
+	res.steps = 0;
+
+	double stress = fairleadStress(h, buf);
+	int useStress = (stress > 0.0);	// ramps run to a stress level only for SYNCOM lines
+	if (!useStress)
+		cout << "   Line 1 has no SYNCOM stress; ramps last " << opt.hold << " s instead." << endl;
+
+	int err = 0;
+	for (int p=0; (p < phases.size()) && !err && (t < opt.tmax); p++)
+	{
+		long nSteps = 0;
+		double dir = 1.0;
+		if (phases[p].type == RAMP)
+		{
+			if (useStress)
+			{
+				dir = (stress < phases[p].value) ? 1.0 : -1.0;
+				nSteps = (long)ceil(opt.tmax/dt);		// ends on reaching the stress level
+			}
+			else
+				nSteps = (long)ceil(opt.hold/dt);
+		}
+		else if (phases[p].type == HOLD)
+			nSteps = (long)ceil(phases[p].value/dt);
+		else
+			nSteps = (long)ceil(opt.period*phases[p].value/dt);
+
+		double tp = t;		// start time of the phase
+		double w = 2.0*pi/opt.period;
+		for (long i=0; (i < nSteps) && (t < opt.tmax); i++)
+		{
+			if (phases[p].type == RAMP)
+			{
+				if (useStress && (dir*(stress - phases[p].value) >= 0.0))
+					break;
+				XD[0] = dir*opt.speed;
+			}
+			else if (phases[p].type == HOLD)
+				XD[0] = 0.0;
+			else
+				XD[0] = -opt.amp*w*cos(w*(t - tp));
+
+			X[0] += XD[0]*dt;
+			double tStep = t;
+			if (MoorDyn_Step(h, X, XD, F, &tStep, &dt))
+			{
+				cout << "   Error: MoorDyn step failed at t = " << t << " s." << endl;
+				err = 1;
+				break;
+			}
+			t += dt;
+			res.steps++;
+			if (useStress)
+				stress = fairleadStress(h, buf);
+		}
+	}
+	double t2 = wallTime();
+
+	res.tSim = t;
+	res.tInit = t1 - t0;
+	res.tRun = t2 - t1;
+	res.peakMB = peakMemoryMB();
+
+	res.prof.clear();
+	int nProf = MoorDyn_GetProfile(h, NULL, 0);
+	if (opt.profile && (nProf > 0))
+	{
+		res.prof.resize(nProf);
+		MoorDyn_GetProfile(h, &res.prof[0], nProf);
+	}
+
+	MoorDyn_Destroy(h);
+	return err ? -1 : 0;
+}
+
+
+// phase times summed over the lines, the SYNCOM solve count, mean Newton iterations and reused evaluations
+static void lineTotals(const BenchResult& res, double sections[MD_PROF_NLINE], double& nSolves, double& meanIter,
+	double& nReused)
+{
+	for (int k=0; k<MD_PROF_NLINE; k++)  sections[k] = 0.0;
+	nSolves = 0.0;
+	meanIter = 0.0;
+	nReused = 0.0;
+	if (res.prof.empty())  return;
+
+	for (int l=0; l<res.nLines; l++)
+	{
+		const double* p = &res.prof[2*MD_PROF_NSYS + l*MD_PROF_LINESIZE];
+		for (int k=0; k<MD_PROF_NLINE; k++)  sections[k] += p[2*k];
+		for (int k=0; k<MD_PROF_NITER; k++)
+		{
+			nSolves += p[2*MD_PROF_NLINE + k];
+			meanIter += k*p[2*MD_PROF_NLINE + k];
+		}
+		nReused += p[2*MD_PROF_NLINE + MD_PROF_NITER];
+	}
+	if (nSolves > 0.0)  meanIter /= nSolves;
+}
+
+
+static void printResult(const BenchCase& bc, const BenchResult& res)
+{
+	cout << endl << "   Case " << bc.name << ": " << res.nLines << " lines, " << res.nSegs << " segments, dtM = "
+	     << ((bc.segs > 0) ? string("CFL") : ((bc.dtM > 0.0) ? num2str(bc.dtM) : string("input"))) << endl;
+	cout << fixed << setprecision(3);
+	cout << "     steps           " << setw(12) << res.steps << "   (" << res.tSim << " s simulated)" << endl;
+	cout << "     init time       " << setw(12) << res.tInit << " s" << endl;
+	cout << "     run time        " << setw(12) << res.tRun << " s" << endl;
+	cout << "     steps/s         " << setw(12) << ((res.tRun > 0.0) ? res.steps/res.tRun : 0.0) << endl;
+	cout << "     x real time     " << setw(12) << ((res.tRun > 0.0) ? res.tSim/res.tRun : 0.0) << endl;
+	cout << "     peak memory     " << setw(12) << res.peakMB << " MB" << endl;
+
+	if (!res.prof.empty())
+	{
+		const char* sysNames[MD_PROF_NSYS] = {"fairlead update", "connections", "lines", "time integration",
+		                                      "coupling steps", "output", "IC generation"};
+		const char* lineNames[MD_PROF_NLINE] = {"kinematics", "waves", "mass matrix", "segment forces",
+		                                        "  SYNCOM solves", "node forces", "state update"};
+		double sections[MD_PROF_NLINE], nSolves, meanIter, nReused;
+		lineTotals(res, sections, nSolves, meanIter, nReused);
+
+		cout << "     phase times (s, including IC generation):" << endl;
+		for (int k=0; k<MD_PROF_NSYS; k++)
+			cout << "       " << left << setw(18) << sysNames[k] << right << setw(12) << res.prof[2*k] << endl;
+		cout << "     line sections, all lines (s):" << endl;
+		for (int k=0; k<MD_PROF_NLINE; k++)
+			cout << "       " << left << setw(18) << lineNames[k] << right << setw(12) << sections[k] << endl;
+		cout << "     SYNCOM solves   " << setw(12) << setprecision(0) << nSolves
+		     << "   (" << setprecision(2) << meanIter << " Newton iterations on average)" << endl;
+		if (nReused > 0.0)
+			cout << "     SYNCOM reused   " << setw(12) << setprecision(0) << nReused
+			     << "   (" << setprecision(1) << 100.0*nReused/(nSolves + nReused) << "% of the evaluations skipped)" << endl;
+	}
+	cout.unsetf(ios::floatfield);
+	cout << setprecision(6);
+}
+
+
+static void writeCSV(const string& path, const BenchCase& bc, const BenchResult& res)
+{
+	ifstream test(path.c_str());
+	int exists = test.good();
+	test.close();
+
+	ofstream f(path.c_str(), ios::app);
+	if (!f.is_open())
+	{
+		cout << "   Error: unable to write " << path << endl;
+		return;
+	}
+	if (!exists)
+		f << "case,lines,segments,dtM,steps,sim_time,init_s,run_s,steps_per_s,realtime_factor,peak_MB,"
+		  << "fairleads_s,connects_s,lines_s,timestep_s,coupling_s,output_s,icgen_s,"
+		  << "kin_s,waves_s,mass_s,segs_s,syncom_s,nodes_s,states_s,syncom_solves,mean_newton_iter,syncom_reused\n";
+
+	double sections[MD_PROF_NLINE], nSolves, meanIter, nReused;
+	lineTotals(res, sections, nSolves, meanIter, nReused);
+
+	f << bc.name << "," << res.nLines << "," << res.nSegs << ","
+	  << ((bc.segs > 0) ? string("CFL") : ((bc.dtM > 0.0) ? num2str(bc.dtM) : string("input"))) << ","
+	  << res.steps << "," << res.tSim << "," << res.tInit << "," << res.tRun << ","
+	  << ((res.tRun > 0.0) ? res.steps/res.tRun : 0.0) << "," << ((res.tRun > 0.0) ? res.tSim/res.tRun : 0.0) << ","
+	  << res.peakMB;
+	for (int k=0; k<MD_PROF_NSYS; k++)
+		f << "," << (res.prof.empty() ? 0.0 : res.prof[2*k]);
+	for (int k=0; k<MD_PROF_NLINE; k++)
+		f << "," << sections[k];
+	f << "," << nSolves << "," << meanIter << "," << nReused << "\n";
+}
+
+
+static void usage()
+{
+	cout << "usage: MoorDynBench [-dir folder] [-input file] [-motion template|ramp|hold|harmonic] [-sigma s]" << endl
+	     << "                    [-speed v] [-hold s] [-amp a] [-period T] [-cycles n] [-dt s] [-tmax s]" << endl
+	     << "                    [-sweep segs|lines|dtM v1,v2,...] [-csv file] [-noprofile]" << endl
+	     << "                    [-skiptol tol]" << endl;
+}
+
+
+int main(int argc, char** argv)
+{
+	BenchOptions opt;
+	opt.input = "Mooring/lines.txt";
+	opt.motion = "template";
+	opt.sigma = 0.35;
+	opt.speed = 3.5;
+	opt.hold = 10.0;
+	opt.amp = 1.0;
+	opt.period = 10.0;
+	opt.cycles = 20.0;
+	opt.dt = 0.005;
+	opt.tmax = 8000.0;
+	opt.profile = 1;
+	opt.skipTol = -1.0;
+	string dir;
+
+	for (int i=1; i<argc; i++)
+	{
+		string a = argv[i];
+		int more = (i+1 < argc);
+		if      ((a == "-dir")    && more)  dir        = argv[++i];
+		else if ((a == "-input")  && more)  opt.input  = argv[++i];
+		else if ((a == "-motion") && more)  opt.motion = argv[++i];
+		else if ((a == "-sigma")  && more)  opt.sigma  = atof(argv[++i]);
+		else if ((a == "-speed")  && more)  opt.speed  = atof(argv[++i]);
+		else if ((a == "-hold")   && more)  opt.hold   = atof(argv[++i]);
+		else if ((a == "-amp")    && more)  opt.amp    = atof(argv[++i]);
+		else if ((a == "-period") && more)  opt.period = atof(argv[++i]);
+		else if ((a == "-cycles") && more)  opt.cycles = atof(argv[++i]);
+		else if ((a == "-dt")     && more)  opt.dt     = atof(argv[++i]);
+		else if ((a == "-tmax")   && more)  opt.tmax   = atof(argv[++i]);
+		else if ((a == "-csv")    && more)  opt.csv    = argv[++i];
+		else if (a == "-noprofile")         opt.profile = 0;
+		else if ((a == "-skiptol") && more) opt.skipTol = atof(argv[++i]);
+		else if ((a == "-sweep") && (i+2 < argc))
+		{
+			opt.sweep = argv[++i];
+			string list = argv[++i];
+			for (size_t j=0; j<list.size(); j++)  if (list[j] == ',')  list[j] = ' ';
+			vector<string> v = splitWords(list);
+			for (int j=0; j<v.size(); j++)  opt.sweepValues.push_back(atof(v[j].c_str()));
+		}
+		else
+		{
+			usage();
+			return 1;
+		}
+	}
+
+	// the paths are relative to the working folder
+	if (!dir.empty() && chdir(dir.c_str()))
+	{
+		cout << "   Error: unable to change to folder " << dir << endl;
+		return 1;
+	}
+
+	// motion phases (the template follows Matlab/template.m)
+	vector<MotionPhase> phases;
+	MotionPhase ph;
+	if (opt.motion == "template")
+	{
+		ph.type = RAMP;      ph.value = 0.1;         phases.push_back(ph);
+		ph.type = RAMP;      ph.value = 0.35;        phases.push_back(ph);
+		ph.type = HARMONIC;  ph.value = opt.cycles;  phases.push_back(ph);
+	}
+	else if (opt.motion == "ramp")      { ph.type = RAMP;      ph.value = opt.sigma;   phases.push_back(ph); }
+	else if (opt.motion == "hold")      { ph.type = HOLD;      ph.value = opt.hold;    phases.push_back(ph); }
+	else if (opt.motion == "harmonic")  { ph.type = HARMONIC;  ph.value = opt.cycles;  phases.push_back(ph); }
+	else
+	{
+		usage();
+		return 1;
+	}
+
+	// cases
+	vector<BenchCase> cases;
+	BenchCase bc;
+	bc.segs = 0;
+	bc.copies = 1;
+	bc.dtM = 0.0;
+	if (opt.sweep.empty())
+	{
+		bc.name = "base";
+		cases.push_back(bc);
+	}
+	for (int j=0; j<opt.sweepValues.size(); j++)
+	{
+		BenchCase c = bc;
+		if      (opt.sweep == "segs")   c.segs   = (int)opt.sweepValues[j];
+		else if (opt.sweep == "lines")  c.copies = (int)opt.sweepValues[j];
+		else if (opt.sweep == "dtM")    c.dtM    = opt.sweepValues[j];
+		else
+		{
+			usage();
+			return 1;
+		}
+		c.name = opt.sweep + "=" + num2str(opt.sweepValues[j]);
+		cases.push_back(c);
+	}
+
+	// read the input file
+	vector<string> lines;
+	ifstream in(opt.input.c_str());
+	if (!in.is_open())
+	{
+		cout << "   Error: unable to open " << opt.input << endl;
+		return 1;
+	}
+	string line;
+	while (getline(in, line))
+	{
+		if (!line.empty() && (line[line.size()-1] == '\r'))  line.erase(line.size()-1);
+		lines.push_back(line);
+	}
+	in.close();
+
+	makeDir(benchDir);
+	
+	// the cases read MaterDef.xml and waves.txt from the folder of their input file, else from the working folder
+	string inDir = opt.input.substr(0, opt.input.find_last_of("/\\") + 1);
+	copyFile(inDir + "MaterDef.xml", string(benchDir) + "/MaterDef.xml");
+	copyFile(inDir + "waves.txt", string(benchDir) + "/waves.txt");
+
+	int nFailed = 0;
+	for (int c=0; c<cases.size(); c++)
+	{
+		string path = string(benchDir) + "/case" + num2str(c+1) + ".txt";
+		if (writeCaseInput(lines, cases[c], opt, path))
+			return 1;
+
+		BenchResult res;
+		if (runCase(path, phases, opt, res))
+		{
+			cout << "   Case " << cases[c].name << " failed." << endl;
+			nFailed++;
+			continue;
+		}
+		printResult(cases[c], res);
+		if (!opt.csv.empty())
+			writeCSV(opt.csv, cases[c], res);
+	}
+
+	return nFailed ? 1 : 0;
+}
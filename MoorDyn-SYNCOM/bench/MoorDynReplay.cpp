@@ -0,0 +1,320 @@
+/*
+ * Copyright (c) 2014 Matt Hall <mtjhall@alumni.uvic.ca>
+ *
+ * This file is part of MoorDyn.  MoorDyn is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * MoorDyn is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MoorDyn.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// MoorDynReplay: replays a coupling trace recorded with the RecordTrace solver option (Lines.trace, format
+// described in MoorDyn.cpp) through MoorDyn-SYNCOM standalone.  Every recorded call, including dt = 0
+// predictor calls and asynchronous steps, is repeated with the same inputs; the resulting loads are compared
+// with the recorded ones and the replay time is reported.
+//
+// usage: MoorDynReplay <trace file> [options]
+//   -dir <folder>      working folder (default: current folder)
+//   -input <file>      mooring input file (default: the path recorded in the trace, relative to the folder)
+//   -tol <rel>         fail if any load deviates from the recorded one by more than rel times the largest
+//                      recorded load magnitude (default: report only)
+//
+// The trace is read completely before the model is initialized, so it may be replayed with an input
+// file that records a new trace into the same folder.
+
+#include "MoorDyn.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <chrono>
+#include <iterator>
+#include <algorithm>
+#include <stdint.h>
+
+#ifdef _WIN32
+ #include <direct.h>
+ #define chdir _chdir
+#else
+ #include <unistd.h>
+#endif
+
+using namespace std;
+
+
+// the hash of the input file stored in the trace (FNV-1a, as hashFNV1a in Misc.cpp)
+static uint64_t hashFNV1a(const void* data, size_t nBytes)
+{
+	uint64_t h = 14695981039346656037ULL;
+	const unsigned char* p = (const unsigned char*)data;
+	for (size_t i=0; i<nBytes; i++)
+	{
+		h ^= p[i];
+		h *= 1099511628211ULL;
+	}
+	return h;
+}
+
+static double wallTime()
+{
+	return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+// sequential reader of the trace held in memory
+class TraceReader
+{
+	vector<char> buf;
+	size_t pos = 0;
+
+public:
+	int load(const char* path)
+	{
+		ifstream f(path, ios::in | ios::binary);
+		if (!f.is_open())
+			return -1;
+		buf.assign(istreambuf_iterator<char>(f), istreambuf_iterator<char>());
+		pos = 0;
+		return 0;
+	}
+	int done() { return pos >= buf.size(); }
+	int read(void* out, size_t nBytes)
+	{
+		if (pos + nBytes > buf.size())
+			return -1;
+		memcpy(out, &buf[pos], nBytes);
+		pos += nBytes;
+		return 0;
+	}
+	int readDoubles(double* out, int n) { return read(out, n*sizeof(double)); }
+};
+
+
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		cout << "usage: MoorDynReplay <trace file> [-dir folder] [-input file] [-tol rel]" << endl;
+		return 1;
+	}
+
+	string tracePath = argv[1];
+	string dir, input;
+	double tol = -1.0;
+	for (int i=2; i<argc; i++)
+	{
+		string a = argv[i];
+		if      ((a == "-dir")   && (i+1 < argc))  dir   = argv[++i];
+		else if ((a == "-input") && (i+1 < argc))  input = argv[++i];
+		else if ((a == "-tol")   && (i+1 < argc))  tol   = atof(argv[++i]);
+		else
+		{
+			cout << "usage: MoorDynReplay <trace file> [-dir folder] [-input file] [-tol rel]" << endl;
+			return 1;
+		}
+	}
+
+	// --- read the trace and its header ---
+	TraceReader tr;
+	if (tr.load(tracePath.c_str()))
+	{
+		cout << "   Error: unable to read " << tracePath << endl;
+		return 1;
+	}
+
+	char magic[4];
+	int version = 0, nFairs = 0, nPath = 0;
+	uint64_t hash = 0;
+	double X[6], XD[6];
+	if (tr.read(magic, 4) || strncmp(magic, "MDTR", 4) || tr.read(&version, sizeof(version)) || (version != 1)
+		|| tr.read(&nFairs, sizeof(nFairs)) || tr.read(&hash, sizeof(hash)) || tr.read(&nPath, sizeof(nPath))
+		|| (nPath < 0) || (nPath > 4096))
+	{
+		cout << "   Error: " << tracePath << " is not a supported coupling trace." << endl;
+		return 1;
+	}
+	string recordedInput(nPath, ' ');
+	if (tr.read(&recordedInput[0], nPath) || tr.readDoubles(X, 6) || tr.readDoubles(XD, 6))
+	{
+		cout << "   Error: " << tracePath << " is incomplete." << endl;
+		return 1;
+	}
+	if (input.empty())
+		input = recordedInput;
+
+	// the paths are relative to the working folder
+	if (!dir.empty() && chdir(dir.c_str()))
+	{
+		cout << "   Error: unable to change to folder " << dir << endl;
+		return 1;
+	}
+
+	ifstream infile(input.c_str(), ios::in | ios::binary);
+	stringstream contents;
+	contents << infile.rdbuf();
+	string str = contents.str();
+	if (str.empty())
+	{
+		cout << "   Error: unable to read the input file " << input << endl;
+		return 1;
+	}
+	if (hashFNV1a(str.c_str(), str.size()) != hash)
+		cout << "   Warning: " << input << " differs from the input file the trace was recorded with." << endl;
+
+	// --- replay ---
+	MoorDynHandle h = MoorDyn_Create(input.c_str());
+	double t0 = wallTime();
+	if (MoorDyn_Init(h, X, XD))
+	{
+		cout << "   Error: initialization failed." << endl;
+		MoorDyn_Destroy(h);
+		return 1;
+	}
+	double t1 = wallTime();
+
+	double** rFair = new double*[nFairs];
+	double** rdFair = new double*[nFairs];
+	double** fFair = new double*[nFairs];
+	for (int l=0; l<nFairs; l++)
+	{
+		rFair[l] = new double[3];
+		rdFair[l] = new double[3];
+		fFair[l] = new double[3];
+	}
+
+	long nCalls[4] = {0, 0, 0, 0};		// L, F, A, W
+	long nPredictor = 0;			// calls with dt = 0
+	long nCompared = 0;
+	double maxDiff = 0.0, maxRef = 0.0, tEnd = 0.0;
+	int err = 0;
+	vector<double> out(max(6, 3*nFairs)), ref(max(6, 3*nFairs)), rec(2 + 6*nFairs + 14);
+	int nOut = 0;		// number of result values of the last call
+
+	while (!tr.done() && !err)
+	{
+		char type;
+		tr.read(&type, 1);
+		if (type == 'L')
+		{
+			if (tr.readDoubles(&rec[0], 14))  break;
+			double t = rec[0], dt = rec[1];
+			for (int J=0; J<6; J++)  {
+				X[J] = rec[2+J];
+				XD[J] = rec[8+J];
+			}
+			err = MoorDyn_Step(h, X, XD, &out[0], &t, &dt);
+			nOut = 6;
+			nCalls[0]++;
+			if (rec[1] == 0.0)  nPredictor++;
+			tEnd = rec[0] + rec[1];
+		}
+		else if (type == 'F')
+		{
+			if (tr.readDoubles(&rec[0], 2 + 6*nFairs))  break;
+			double t = rec[0], dt = rec[1];
+			for (int l=0; l<nFairs; l++)
+				for (int J=0; J<3; J++)  {
+					rFair[l][J] = rec[2 + 3*l + J];
+					rdFair[l][J] = rec[2 + 3*nFairs + 3*l + J];
+					fFair[l][J] = 0.0;
+				}
+			err = MoorDyn_StepFairleads(h, rFair, rdFair, fFair, &t, &dt);
+			for (int l=0; l<nFairs; l++)
+				for (int J=0; J<3; J++)  out[3*l + J] = fFair[l][J];
+			nOut = 3*nFairs;
+			nCalls[1]++;
+			if (rec[1] == 0.0)  nPredictor++;
+			tEnd = rec[0] + rec[1];
+		}
+		else if (type == 'A')
+		{
+			if (tr.readDoubles(&rec[0], 14))  break;
+			double t = rec[0], dt = rec[1];
+			for (int J=0; J<6; J++)  {
+				X[J] = rec[2+J];
+				XD[J] = rec[8+J];
+			}
+			err = MoorDyn_StepAsync(h, X, XD, &t, &dt);
+			nOut = 0;
+			nCalls[2]++;
+			tEnd = rec[0] + rec[1];
+		}
+		else if (type == 'W')
+		{
+			if (tr.readDoubles(&rec[0], 13))  break;
+			for (int J=0; J<6; J++)  {
+				X[J] = rec[1+J];
+				XD[J] = rec[7+J];
+			}
+			if (rec[0] > 0.0)
+				err = MoorDyn_StepWait(h, X, XD, &out[0]);
+			else
+				err = MoorDyn_StepWait(h, NULL, NULL, &out[0]);
+			nOut = 6;
+			nCalls[3]++;
+		}
+		else if ((type == 'R') && (nOut > 0))
+		{
+			if (tr.readDoubles(&ref[0], nOut))  break;
+			for (int i=0; i<nOut; i++)
+			{
+				maxDiff = max(maxDiff, fabs(out[i] - ref[i]));
+				maxRef = max(maxRef, fabs(ref[i]));
+			}
+			nCompared++;
+		}
+		else
+		{
+			cout << "   Error: unexpected record in the trace." << endl;
+			err = 1;
+		}
+	}
+	double t2 = wallTime();
+
+	if (err)
+		cout << "   Error: replayed call failed (t = " << tEnd << " s)." << endl;
+
+	MoorDyn_Destroy(h);
+	for (int l=0; l<nFairs; l++)
+	{
+		delete[] rFair[l];
+		delete[] rdFair[l];
+		delete[] fFair[l];
+	}
+	delete[] rFair;
+	delete[] rdFair;
+	delete[] fFair;
+
+	// --- report ---
+	long nTotal = nCalls[0] + nCalls[1] + nCalls[2] + nCalls[3];
+	cout << endl << "   Replayed " << tracePath << " (" << tEnd << " s simulated)" << endl;
+	cout << "     LinesCalc calls       " << nCalls[0] << endl;
+	cout << "     FairleadsCalc calls   " << nCalls[1] << endl;
+	cout << "     async steps           " << nCalls[2] << " started, " << nCalls[3] << " completed" << endl;
+	cout << "     dt = 0 calls          " << nPredictor << endl;
+	cout << "     init time             " << t1 - t0 << " s" << endl;
+	cout << "     replay time           " << t2 - t1 << " s  (" << ((t2 > t1) ? nTotal/(t2 - t1) : 0.0) << " calls/s)" << endl;
+	cout << "     max load deviation    " << maxDiff << " (largest recorded load " << maxRef << ", "
+	     << nCompared << " calls compared)" << endl;
+
+	if (err)
+		return 1;
+	if ((tol >= 0.0) && (maxDiff > tol*maxRef))
+	{
+		cout << "   Loads deviate from the trace by more than the tolerance." << endl;
+		return 2;
+	}
+	return 0;
+}
@@ -66,6 +66,11 @@ void Connection::setup(ConnectProps& props)
 						
 	 r_ves.resize(3, 0.0);	
 	rd_ves.resize(3, 0.0);	
+	
+	 rSync.resize(3, 0.0);
+	rdSync.resize(3, 0.0);
+	tSync0 = 0.;
+	tSync1 = 0.;
 			
 	Fnet.resize(3, 0.0);	// total force on node
 	Fnet_i.resize(3, 0.0);
@@ -102,6 +107,24 @@ void Connection::getConnectState(vector<double> &r_out, vector<double> &rd_out)
 };
 
 
+// function to return connection position and velocity at a given time to Line object.  Within an open 
+// synchronization interval, the state is interpolated linearly between the start and end of the interval 
+// (this does not modify the connection, so lines with local time steps can call it concurrently).
+void Connection::getConnectState(const double time, vector<double> &r_out, vector<double> &rd_out)
+{
+	if ((tSync1 > tSync0) && (time < tSync1)) 
+	{
+		double frac = (time - tSync0)/(tSync1 - tSync0);
+		for (int J=0; J<3; J++) {
+			r_out[J] = rSync[J] + frac*(r[J] - rSync[J]);
+			rd_out[J] = rdSync[J] + frac*(rd[J] - rdSync[J]);
+		}
+	}
+	else
+		getConnectState(r_out, rd_out);
+};
+
+
 // function to return net force on fairlead (just to allow public reading of Fnet
 void Connection::getFnet(double Fnet_out[])
 {
@@ -342,6 +365,67 @@ void Connection::updateFairlead( const double time)
 	return;
 }
 	
+// set connect-type kinematics directly from the state vector (positions and velocities at X+3 and X)
+void Connection::setConnectState( const double* X, const double time)
+{
+	t = time;
+	for (int J=0; J<3; J++) 	{
+		r[J]  = X[3 + J];
+		rd[J] = X[J];
+	}
+}
+
+
+// store current kinematics as the start of a synchronization interval (also closes any open interval)
+void Connection::syncStart( const double time)
+{
+	for (int J=0; J<3; J++)  {
+		rSync[J] = r[J];
+		rdSync[J] = rd[J];
+	}
+	tSync0 = time;
+	tSync1 = time;
+}
+
+
+// open the synchronization interval up to the current kinematics, which are taken to be at time
+void Connection::syncEnd( const double time)
+{
+	tSync1 = time;
+}
+
+
+// save/restore the kinematics and boundary condition data (checkpoints)
+void Connection::saveState( ostream& out)
+{
+	out.write((char*)&r[0], 3*sizeof(double));
+	out.write((char*)&rd[0], 3*sizeof(double));
+	out.write((char*)&r_ves[0], 3*sizeof(double));
+	out.write((char*)&rd_ves[0], 3*sizeof(double));
+	out.write((char*)&t, sizeof(double));
+	out.write((char*)&t0, sizeof(double));
+}
+
+int Connection::loadState( istream& in)
+{
+	in.read((char*)&r[0], 3*sizeof(double));
+	in.read((char*)&rd[0], 3*sizeof(double));
+	in.read((char*)&r_ves[0], 3*sizeof(double));
+	in.read((char*)&rd_ves[0], 3*sizeof(double));
+	in.read((char*)&t, sizeof(double));
+	in.read((char*)&t0, sizeof(double));
+	tSync0 = t;		// no interpolation interval is open between coupling steps
+	tSync1 = t;
+	return in ? 0 : 1;
+}
+
+// number of bytes written by saveState
+size_t Connection::getStateSize()
+{
+	return 14*sizeof(double);
+}
+
+	
 Connection::~Connection()
 {
 	// destructor
@@ -351,6 +435,8 @@ Connection::~Connection()
 	 
 	 r_ves.clear();	
 	rd_ves.clear();	
+	 rSync.clear();
+	rdSync.clear();
 			
 	Fnet.clear();	// total force on node
 	Fnet_i.clear();
@@ -55,6 +55,12 @@ class Connection
 	vector< double > rd_ves;		// fairlead velocity for vessel node  types [x/y/z]
 	
 	double tlast;
+	
+	// kinematics at the start of the current synchronization interval (for lines with local time steps)
+	vector< double > rSync;
+	vector< double > rdSync;
+	double tSync0;	// start of the synchronization interval
+	double tSync1;	// end of the synchronization interval (equal to tSync0 when no interpolation is active)
 		
 	vector< double > Fnet;	// total force on node
 	vector< double > Fnet_i;
@@ -78,6 +84,7 @@ public:
 	void addLineToConnect(Line& theLine, int TopOfLine);
 	
 	void getConnectState(vector<double> &r_out, vector<double> &rd_out);
+	void getConnectState(const double time, vector<double> &r_out, vector<double> &rd_out);
 		
 	void getFnet(double Fnet_out[]);
 	
@@ -96,6 +103,14 @@ public:
 	
 	void initiateStep(double FairIn[3], double rdFairIn[3], double time);	
 	void updateFairlead( const double time);
+	
+	void setConnectState( const double* X, const double time);
+	void syncStart( const double time);
+	void syncEnd( const double time);
+	
+	void saveState( ostream& out);
+	int loadState( istream& in);
+	size_t getStateSize();
 };
 
 #endif
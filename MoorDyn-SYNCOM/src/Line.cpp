@@ -18,6 +18,7 @@
 #include "Connection.h"
 #include "QSlines.h" // the c++ version of quasi-static model Catenary
 #include "MoorDyn.h"
+#include "OutputWriter.h"
 
 using namespace std;
 
@@ -32,7 +33,7 @@ using namespace std;
 // set up line object
 void Line::setup(int number_in, LineProps props, double UnstrLen_in, int NumNodes, 
 	Connection &AnchConnect_in, Connection &FairConnect_in,
-	shared_ptr<ofstream> outfile_pointer, string channels_in)
+	shared_ptr<ofstream> outfile_pointer, string channels_in, string outDir_in)
 {
 
 	// ================== set up properties ===========	
@@ -40,13 +41,28 @@ void Line::setup(int number_in, LineProps props, double UnstrLen_in, int NumNode
 	UnstrLen = UnstrLen_in;
 	N = NumNodes; // assign number of nodes to line
 	
+	setProfile(0);
+	
 	WaveKin = 0;  // start off with wave kinematics disabled.  Can be enabled after initial conditions are found and wave kinematics are calculated
 	
 	AnchConnect = &AnchConnect_in;		// assign line end connections
 	FairConnect = &FairConnect_in;	
 		
 	outfile = outfile_pointer.get(); 		// make outfile point to the right place
+	outDir = outDir_in;						// folder of the system's input file
 	channels = channels_in; 				// copy string of output channels to object
+	outWriter = NULL;
+	
+	// parse the output channel flags once
+	outFlags = 0;
+	if (channels.find("p") != string::npos)  outFlags |= OUT_POS;
+	if (channels.find("v") != string::npos)  outFlags |= OUT_VEL;
+	if (channels.find("u") != string::npos)  outFlags |= OUT_WAVEU;
+	if (channels.find("D") != string::npos)  outFlags |= OUT_DRAG;
+	if (channels.find("t") != string::npos)  outFlags |= OUT_TEN;
+	if (channels.find("c") != string::npos)  outFlags |= OUT_DAMP;
+	if (channels.find("s") != string::npos)  outFlags |= OUT_STRAIN;
+	if (channels.find("d") != string::npos)  outFlags |= OUT_STRRATE;
 			
 	d = props.d;
 	rho = props.w/(pi/4.*d*d);
@@ -72,7 +88,7 @@ void Line::setup(int number_in, LineProps props, double UnstrLen_in, int NumNode
 	if (viscoE) {
 		mat_props = new rope::MatProps;
 		stressCalc = new rope::stressSolver(*&mat_props);
-		flagSC = rope::SC_initialize(N, input_fileSC, props.type, *stressCalc);
+		flagSC = rope::SC_initialize(N, inputPath(outDir, input_fileSC), props.type, *stressCalc);
 
 		if (flagSC) {
 			cout << "\n Read failed. Check SynCOM_log file for details! \n" << endl;
@@ -107,6 +123,18 @@ void Line::setup(int number_in, LineProps props, double UnstrLen_in, int NumNode
 	lstr.resize(N, 0.0); 		// stretched lengths
 	ldstr.resize(N, 0.0); 		// rate of stretch
 	V.resize(N, 0.0);			// volume?
+	EAt.resize(N, 0.0);		// axial tangent stiffness
+	
+	Kseg.resize(9*N, 0.0);		// semi-implicit integration work arrays
+	KCseg.resize(9*N, 0.0);
+	Jsub.resize(9*(N-1), 0.0);
+	Jdiag.resize(9*(N-1), 0.0);
+	Jsup.resize(9*(N-1), 0.0);
+	Jrhs.resize(3*(N-1), 0.0);
+	
+	Xd0.resize(6*(N-1), 0.0);	// local RK2 integration work arrays
+	Xt.resize(6*(N-1), 0.0);
+	Xd1.resize(6*(N-1), 0.0);
 	
 	zeta.resize(N+1, 0.0);					// wave elevation above each node
 	F.resize(N+1, 0.0); 	// fixed 2014-12-07	// VOF scalar for each NODE (mean of two half adjacent segments) (1 = fully submerged, 0 = out of water)
@@ -294,6 +322,30 @@ void Line::initialize( double* X )
 	// Initialize with Catenary Equations;
 	int success = Catenary(XF, ZF, UnstrLen, E * pi / 4. * d * d, W, CB, Tol, &HF, &VF, &HA, &VA, N, snodes, Xl, Zl, Te);
 
+	//------------------------- SYNCOM Modifications---------------------------------
+	// For SYNCOM lines, redo the catenary with the instantaneous SYNCOM tangent stiffness at the mean
+	// line tension of the previous solution (a few passes, starting from the input EA)
+	if (viscoE && (success >= 0))
+	{
+		for (int pass=0; pass<3; pass++)
+		{
+			double Tmean = 0.0;
+			for (int i=0; i<=N; i++)  Tmean += Te[i]/(N+1);
+			
+			double sigma = Tmean/(pi/4.*d*d)/stressCalc->material_props->MBL;
+			double EAcat = stressCalc->calStiff(sigma)*pi/4.*d*d;
+			if (!(EAcat > 0.0))
+				break;
+			
+			if (Catenary(XF, ZF, UnstrLen, EAcat, W, CB, Tol, &HF, &VF, &HA, &VA, N, snodes, Xl, Zl, Te) < 0)
+			{	// fall back to the input EA solution
+				success = Catenary(XF, ZF, UnstrLen, E * pi / 4. * d * d, W, CB, Tol, &HF, &VF, &HA, &VA, N, snodes, Xl, Zl, Te);
+				break;
+			}
+		}
+	}
+	//---------------------------- End Modifications---------------------------------
+
 	if (success>=0)
 	{	// assign the resulting line positions to the model
 		for (int i=1; i<N; i++)
@@ -370,6 +422,54 @@ int Line::getNodePos_v2(int NodeNum, double* pos)
 		return -1;  // indicate an error */
 }
 
+// bulk accessors for post-processing, filling caller arrays for the whole line
+void Line::getNodePositions(double* out)
+{
+	for (int i=0; i<=N; i++)
+		for (int J=0; J<3; J++)  out[3*i + J] = r[i][J];
+}
+
+void Line::getNodeVelocities(double* out)
+{
+	for (int i=0; i<=N; i++)
+		for (int J=0; J<3; J++)  out[3*i + J] = rd[i][J];
+}
+
+void Line::getSegTensions(double* out)
+{
+	for (int i=0; i<N; i++)  
+		out[i] = sqrt(T[i][0]*T[i][0] + T[i][1]*T[i][1] + T[i][2]*T[i][2]);
+}
+
+void Line::getSegStrains(double* out)
+{
+	for (int i=0; i<N; i++)  out[i] = (lstr[i] - l[i])/l[i];
+}
+
+// switches the timing of the doRHS sections on or off and clears the accumulated profile
+void Line::setProfile(int profileIn)
+{
+	profile = profileIn;
+	for (int k=0; k<LPROF_NLINE; k++)  prof[k].reset();
+	for (int k=0; k<LPROF_NITER; k++)  newtonHist[k] = 0;
+	SCreused = 0;
+}
+
+const ProfTimer* Line::getProfile()
+{
+	return prof;
+}
+
+const long* Line::getNewtonHist()
+{
+	return newtonHist;
+}
+
+long Line::getSCreused()
+{
+	return SCreused;
+}
+
 // FASTv7 style line tension outputs
 void Line::getFASTtens(float* FairHTen, float* FairVTen, float* AnchHTen, float* AnchVTen)
 {		
@@ -403,6 +503,24 @@ int Line::getN()
 	return N;
 };
 
+// CFL-limited explicit time step of the line: the smallest segment length divided by the
+// axial wave speed sqrt(Et/rho), with Et the current tangent modulus (E for linear lines,
+// the instantaneous SYNCOM stiffness at the committed segment stress for viscoE lines)
+double Line::getStableDt()
+{
+	double dtMin = 1.0e10;
+	for (int i=0; i<N; i++)
+	{
+		double Et = E;
+		if (viscoE)
+			Et = stressCalc->calStiff(stressCalc->get_sigmaim1(i));
+		
+		if (Et > 0.0)
+			dtMin = min(dtMin, l[i]/sqrt(Et/rho));
+	}
+	return dtMin;
+};
+
 
 double Line::GetLineOutput(OutChanProps outChan)
 {	
@@ -452,10 +570,9 @@ void Line::setupWaves(EnvCond env_in, vector<double> Ucurrent_in, float dt_in)
 	WGNC_Fact = 1.0;
 	S2Sd_Fact = 1.0;
 	// resize the new time series vectors
-	zetaTS.resize(N+1, vector<double>(Nt, 0.));
-	FTS.resize   (N+1, vector<double>(Nt, 0.));
-	UTS.resize   (N+1, vector< vector< double> >(Nt, vector<double>(3, 0.)));
-	UdTS.resize  (N+1, vector< vector< double> >(Nt, vector<double>(3, 0.)));
+	tsWin0 = 0;
+	NtWin = Nt;
+	waveTS.assign(NtWin*(N+1)*7, 0.0f);
 	tTS.resize(Nt, 0.);
 };
 
@@ -601,21 +718,177 @@ void Line::setupWaves(EnvCond env_in, vector<floatC> zetaC_in,  double WaveDOmeg
 //	Ucurrent = Ucurrent_in;
 	
 	// resize the new time series vectors
+	// (the kinematics storage itself is sized in makeWaveKinematics, depending on env.WaveWindow)
 	if (Nt > 0)
-	{
-		zetaTS.resize(N+1, vector<double>(Nt, 0.));
-		FTS.resize   (N+1, vector<double>(Nt, 0.));
-		UTS.resize   (N+1, vector< vector< double> >(Nt, vector<double>(3, 0.)));
-		UdTS.resize  (N+1, vector< vector< double> >(Nt, vector<double>(3, 0.)));
 		tTS.resize(Nt, 0.);
-	}
 
 	if (wordy>1) cout << "   Done Waves initialization" << endl << endl;
 	
 };
 
+// fills cx_in with the Hermitian parts of two spectra as X + iY, so that a single complex inverse FFT
+// returns both real time series: x in the real part of the output and y in the imaginary part
+static void packSpectra(int NFFT, const vector< floatC > &X, const vector< floatC > &Y, kiss_fft_cpx* cx_in)
+{
+	for (int I=0; I<NFFT; I++)
+	{
+		int Im = (NFFT - I) % NFFT;		// index of the mirrored (negative) frequency
+		floatC Z = 0.5f*(X[I] + conj(X[Im])) + i1f*0.5f*(Y[I] + conj(Y[Im]));
+		cx_in[I].r = real(Z);
+		cx_in[I].i = imag(Z);
+	}
+}
+
+
+// frequency-domain wave elevation, velocities and accelerations at node i, written to 
+// spec[0] (zeta), spec[1-3] (U x/y/z) and spec[4-6] (Ud x/y/z)
+void Line::waveSpectra(int i, vector< vector< floatC > > &spec)
+{
+	float x = (float)rWave[i][0]; // rename node positions for convenience 
+	float y = (float)rWave[i][1];
+	float z = (float)rWave[i][2];
+	
+	for (int I=0; I<Nw; I++)  // Loop through the frequency components of the Fourier transforms
+	{
+		floatC zetaCI = zetaC0[I]* exp( -i1f*(k[I]*(cos(beta)*x + sin(beta)*y)));   // shift each zetaC to account for location
+		spec[0][I] = zetaCI;
+	
+		// Fourier transform of wave velocities
+		spec[1][I] =      w[I]* zetaCI*COSHNumOvrSIHNDen ( k[I], env.WtrDpth, z )*cos(beta);
+		spec[2][I] =      w[I]* zetaCI*COSHNumOvrSIHNDen ( k[I], env.WtrDpth, z )*sin(beta);
+		spec[3][I] = i1f* w[I]* zetaCI*SINHNumOvrSIHNDen ( k[I], env.WtrDpth, z );
+
+		// Fourier transform of wave accelerations
+		for (int J=0; J<3; J++)  spec[4+J][I] = i1f*w[I]*spec[1+J][I];	// should confirm correct signs of +/- halves of spectrum here
+	}
+}
+
+
+// stores one value of series s (0 = zeta, 1-3 = U x/y/z, 4-6 = Ud x/y/z) at wave time step ts of node i
+void Line::setWaveTS(int i, int ts, int s, double val)
+{
+	waveTS[((ts - tsWin0)*(N+1) + i)*7 + s] = (float)val;
+}
+
+
+// generates the wave kinematics for the window of NtWin wave time steps starting at tsStart by direct
+// summation of the Fourier series (only the positive-frequency half, using the Hermitian part of each
+// spectrum, so the result is the full-length IFFT of makeWaveKinematics up to rounding).  This is called
+// from doRHS, which may already run in parallel over the lines, so the nodes are done serially.
+void Line::makeWaveWindow(int tsStart)
+{
+	tsWin0 = max(0, min(tsStart, Nt - NtWin));
+	int NFFT = Nt;
+	
+	vector< vector< floatC > > spec(7, vector< floatC >(Nw, 0.));	// spectra of one node
+	vector< double > acc(7*NtWin);
+	
+	for (int i=0; i<=N; i++)
+	{
+		waveSpectra(i, spec);
+		
+		for (int n=0; n<7*NtWin; n++)  acc[n] = 0.0;
+		
+		for (int I=0; I<=NFFT/2; I++)
+		{
+			double fac = ((I == 0) || (2*I == NFFT)) ? 1.0 : 2.0;  // the negative frequencies give the conjugate terms
+			int Im = (NFFT - I) % NFFT;
+			
+			doubleC Xh[7];
+			for (int s=0; s<7; s++)
+				Xh[s] = fac*0.5*(doubleC(spec[s][I]) + conj(doubleC(spec[s][Im])));
+			
+			// phasor exp(i 2pi I n/NFFT), starting at the first step of the window and rotated each step
+			double ang0 = 2.0*pi*double(((long long)I*tsWin0) % NFFT)/NFFT;
+			doubleC ph(cos(ang0), sin(ang0));
+			doubleC step(cos(2.0*pi*I/NFFT), sin(2.0*pi*I/NFFT));
+			
+			for (int n=0; n<NtWin; n++)
+			{
+				for (int s=0; s<7; s++)  
+					acc[7*n + s] += real(Xh[s]*ph);
+				ph *= step;
+			}
+		}
+		
+		for (int n=0; n<NtWin; n++)
+			for (int s=0; s<7; s++)
+				setWaveTS(i, tsWin0 + n, s, acc[7*n + s]/Nw);
+	}
+}
+
+
+// hash of everything the precalculated wave kinematics depend on (used to key the on-disk cache)
+uint64_t Line::waveKinHash( double t0 )
+{
+	uint64_t h = hashFNV1a(&Nt, sizeof(Nt));
+	h = hashFNV1a(&N, sizeof(N), h);
+	h = hashFNV1a(&t0, sizeof(t0), h);
+	h = hashFNV1a(&WaveDT, sizeof(WaveDT), h);
+	h = hashFNV1a(&dw, sizeof(dw), h);
+	h = hashFNV1a(&beta, sizeof(beta), h);
+	h = hashFNV1a(&env.g, sizeof(env.g), h);
+	h = hashFNV1a(&env.WtrDpth, sizeof(env.WtrDpth), h);
+	h = hashFNV1a(&zetaC0[0], Nw*sizeof(floatC), h);
+	for (int i=0; i<=N; i++)
+		h = hashFNV1a(&rWave[i][0], 3*sizeof(double), h);
+	return h;
+}
+
+
+// on-disk wave kinematics cache for this line: a small header (with the input hash) followed by the 
+// float32 time-major kinematics store.  Returns 1 if the cache matched and was read, 0 otherwise.
+int Line::readWaveCache( uint64_t waveHash )
+{
+	stringstream fname;
+	fname << outDir << "WaveCache_Line" << number << ".bin";
+	ifstream cachefile(fname.str().c_str(), ios::in | ios::binary);
+	if (!cachefile.is_open())
+		return 0;
+	
+	char magic[4];
+	uint64_t hashIn;
+	int NtIn, NIn;
+	cachefile.read(magic, 4);
+	cachefile.read((char*)&hashIn, sizeof(hashIn));
+	cachefile.read((char*)&NtIn, sizeof(NtIn));
+	cachefile.read((char*)&NIn, sizeof(NIn));
+	if ((!cachefile) || (strncmp(magic, "MDW2", 4) != 0) || (hashIn != waveHash) || (NtIn != Nt) || (NIn != N))
+		return 0;
+	
+	cachefile.read((char*)&waveTS[0], waveTS.size()*sizeof(float));
+	if (!cachefile)
+		return 0;
+	
+	if (wordy>0) cout << "   Read wave kinematics of Line " << number << " from " << fname.str() << endl;
+	return 1;
+}
+
+void Line::writeWaveCache( uint64_t waveHash )
+{
+	stringstream fname;
+	fname << outDir << "WaveCache_Line" << number << ".bin";
+	ofstream cachefile(fname.str().c_str(), ios::out | ios::binary);
+	if (!cachefile.is_open())
+	{
+		cout << "   Warning: unable to write wave kinematics cache " << fname.str() << endl;
+		return;
+	}
+	
+	cachefile.write("MDW2", 4);
+	cachefile.write((char*)&waveHash, sizeof(waveHash));
+	cachefile.write((char*)&Nt, sizeof(Nt));
+	cachefile.write((char*)&N, sizeof(N));
+	cachefile.write((char*)&waveTS[0], waveTS.size()*sizeof(float));
+	cachefile.close();
+}
+
+
 // precalculates wave kinematics for a given set of node points for a series of time steps
 // re-made on Feb 23rd 2015 to accept fft of wave elevation from any source
+// The real time series are computed in pairs (one complex IFFT per two series) with a shared 
+// plan, in parallel over the nodes, and can be stored to/read from disk (env.WaveCache, in the
+// folder of the input file).  LinesInit calls this for the lines in parallel.
 void Line::makeWaveKinematics( double t0 )
 {
 	// inputs are t0 - start time
@@ -624,149 +897,88 @@ void Line::makeWaveKinematics( double t0 )
 	// function calculates wave kinematics and free surface elevation at each X
 	
 	WaveKin = 1;  // enable wave kinematics now that they're going to be calculated
+	
+	rWave = r;    // the kinematics are computed at the current node positions, also for later windows
 
-		
-	// ----------------  start the FFT stuff using kiss_fft ---------------------------------------
-	if (wordy>2) cout << "starting fft stuff " << endl;
 	int NFFT = Nt;
-	int is_inverse_fft = 1;
-	kiss_fft_cfg cfg = kiss_fft_alloc( NFFT , is_inverse_fft ,0,0 );
 	
-	if (wordy>2) cout << "allocatin io " << endl;
+	// scale time vector ....
+	for (int ts=0; ts<Nt; ts++)	tTS[ts] = t0 + double(ts)*WaveDT; // time
 	
-	kiss_fft_cpx* cx_in   = (kiss_fft_cpx*)malloc(NFFT*sizeof(cx_in));
-	kiss_fft_cpx* cx_out  = (kiss_fft_cpx*)malloc(NFFT*sizeof(cx_out));
-		
-		
-		
-	// calculating wave kinematics on node i located at point x, y, z
-
+	// lazy mode: only keep a window of the time series, generated ahead of the simulation time in doRHS
+	if ((env.WaveWindow > 0.0) && (ceil(env.WaveWindow/WaveDT) + 2 < Nt))
+	{
+		NtWin = ceil(env.WaveWindow/WaveDT) + 2;
+		waveTS.assign(NtWin*(N+1)*7, 0.0f);
+		makeWaveWindow(0);
+		if (wordy>1) cout << "    done wave Kinematics window" << endl;
+		return;
+	}
 	
-	// loop through nodes
-	for (int i=0; i<=N; i++)
-	{	
-		float x = (float)r[i][0]; // rename node positions for convenience 
-		float y = (float)r[i][1];
-		float z = (float)r[i][2];
-		
-		if (wordy>2)  cout << "i=" << i << "  ";
+	tsWin0 = 0;
+	NtWin = Nt;
+	waveTS.assign(NtWin*(N+1)*7, 0.0f);
+	
+	// reuse the kinematics from a previous run of the same sea state and node positions if available
+	uint64_t waveHash = 0;
+	if (env.WaveCache > 0)
+	{
+		waveHash = waveKinHash(t0);
+		if (readWaveCache(waveHash))
+			return;
+	}
+	
+	// ----------------  start the FFT stuff using kiss_fft ---------------------------------------
+	kiss_fft_cfg cfg = getFFTplan( NFFT , 1 );	// shared inverse FFT plan
+	
+	#pragma omp parallel
+	{
+		vector< vector< floatC > > spec(7, vector< floatC >(Nw, 0.));	// per-thread spectra of one node
+		vector< kiss_fft_cpx > cx_in(NFFT);
+		vector< kiss_fft_cpx > cx_out(NFFT);
 		
-		// ---------------- calculate frequency domain velocities and accelerations ------------------
-		// note: all these values are for each node specifically, in turn.  just intermediate values for calculating time series
-		if (env.WaveKin > 0)   // if including wave kinematics <<<<<<<<<<<<<< not in right place...
+		// loop through nodes
+		#pragma omp for schedule(static)
+		for (int i=0; i<=N; i++)
 		{	
-			// calculated wave elevation in freq domain
-			//cout << "starting zetaC" << endl;
-	//		for (int I=0; I<Nw; I++)  // Loop through the positive frequency components (including zero) of the Fourier transforms
-	//		{
-	//			//zetaC[I] =  WGNC_Fact*WGNC[I] *sqrt( 2.0*pi*S2Sd_Fact*WaveS2Sdd[I] )*exp( i1*(k[I]*(cos(beta)*x + sin(beta)*y))); // Fourier transform of wave elevation
-	//				
-	//			zetaC[I] = zetaC0[I]* exp( i1f*(k[I]*(cos(beta)*x + sin(beta)*y)));   // shift each zetaC to account for location
-	//		
-	//			// Fourier transform of wave velocities (note: need to multiply by abs(w) to avoid inverting negative half of spectrum)
-	//			UC[I][0] =  abs(w[I])* zetaC[I]*COSHNumOvrSIHNDen ( k[I], env.WtrDpth, z )*cos(beta); //<<<<<<<<<<<<<<<<<<<<<
-	//			UC[I][1] =  abs(w[I])* zetaC[I]*COSHNumOvrSIHNDen ( k[I], env.WtrDpth, z )*sin(beta);
-	//			UC[I][2] = i1f* w[I] * zetaC[I]*SINHNumOvrSIHNDen ( k[I], env.WtrDpth, z );
-     //
-	//			// Fourier transform of wave accelerations
-	//			for (int J=0; J<3; J++)  UdC[I][J] = i1f*w[I]*UC[I][J];	// should confirm correct signs of +/- halves of spectrum here
-	//		}
+			// ---------------- calculate frequency domain elevation, velocities and accelerations ------------------
+			if (env.WaveKin > 0)   // if including wave kinematics
+				waveSpectra(i, spec);
 			
-			// handle positive-frequency half of spectrum
-			for (int I=0; I<Nw; I++)  // Loop through the positive frequency components (including zero) of the Fourier transforms
+			// ------------------------ convert into time domain using IFFT ------------------------
+			// (zeta, Ux), (Uy, Uz), (Udx, Udy) and Udz are each done with one complex IFFT
+			for (int s=0; s<7; s+=2)
 			{
-				zetaC[I] = zetaC0[I]* exp( -i1f*(k[I]*(cos(beta)*x + sin(beta)*y)));   // shift each zetaC to account for location
-			
-				// Fourier transform of wave velocities (note: need to multiply by abs(w) to avoid inverting negative half of spectrum)
-				UC[I][0] =      w[I]* zetaC[I]*COSHNumOvrSIHNDen ( k[I], env.WtrDpth, z )*cos(beta); //<<<<<<<<<<<<<<<<<<<<<
-				UC[I][1] =      w[I]* zetaC[I]*COSHNumOvrSIHNDen ( k[I], env.WtrDpth, z )*sin(beta);
-				UC[I][2] = i1f* w[I]* zetaC[I]*SINHNumOvrSIHNDen ( k[I], env.WtrDpth, z );
-
-				// Fourier transform of wave accelerations
-				for (int J=0; J<3; J++)  UdC[I][J] = i1f*w[I]*UC[I][J];	// should confirm correct signs of +/- halves of spectrum here
+				int s2 = min(s+1, 6);	// series paired with s (the last one is paired with itself)
+				packSpectra(NFFT, spec[s], spec[s2], &cx_in[0]);
+				kiss_fft( cfg , &cx_in[0] , &cx_out[0] );     	// do the IFFT
+				
+				for (int I=0; I<NFFT; I++)  // copy out the IFFT data to the time series
+				{
+					setWaveTS(i, I, s, cx_out[I].r /(float)Nw);
+					if (s2 != s)  setWaveTS(i, I, s2, cx_out[I].i /(float)Nw);
+				}
 			}
-		//	// handle negative-frequency half of spectrum
-		//	for (int I=Nw/2+1; I<Nw; I++)  // Loop through the negative frequency components
-		//	{
-		//		zetaC[I] = zetaC0[I]* exp( i1f*(k[I]*(cos(beta)*x + sin(beta)*y)));   // shift each zetaC to account for location
-		//	
-		//		// Fourier transform of wave velocities (note: need to multiply by abs(w) to avoid inverting negative half of spectrum)
-		//		UC[I][0] =     w[I]* zetaC[I]*COSHNumOvrSIHNDen ( k[I], env.WtrDpth, z )*cos(beta); //<<<<<<<<<<<<<<<<<<<<<
-		//		UC[I][1] =     w[I]* zetaC[I]*COSHNumOvrSIHNDen ( k[I], env.WtrDpth, z )*sin(beta);
-		//		UC[I][2] = i1f* w[I]* zetaC[I]*SINHNumOvrSIHNDen ( k[I], env.WtrDpth, z );
-          //
-		//		// Fourier transform of wave accelerations
-		//		for (int J=0; J<3; J++)  UdC[I][J] = i1f*w[I]*UC[I][J];	// should confirm correct signs of +/- halves of spectrum here
-		//	}
-			
-			
-			
-			
-		}
-		
-		
-		// ------------------------ convert into time domain using IFFT ------------------------
-		
-		
-		// scale time vector ....
-		for (int ts=0; ts<Nt; ts++)	tTS[ts] = t0 + double(ts)*0.25; // time
+		} // i done looping through nodes
+	}
 	
 	
-		if (wordy>2)  cout << "   processing fft" << endl;
-		
-		// .............................. wave elevation ...............................
-		for (int I=0; I<NFFT; I++)  
-		{			    					// put data into input vector
-			cx_in[I].r = real(zetaC[I]);    	// real component - kiss_fft likes floats
-			cx_in[I].i = imag(zetaC[I]);    	// imaginary component
-		}
-		kiss_fft( cfg , cx_in , cx_out );     	// do the IFFT
-		
-		for (int I=0; I<NFFT; I++)  zetaTS[i][I] = cx_out[I].r /(float)Nw;   // copy out the IFFT data to the time series
-		
-		//if (wordy) if (i==N) for (int I=0; I<NFFT; I++) cout << "fair zeta is " << zetaTS[i][I] << " at time " << tTS[I] << endl;
-		
-		// .............................. wave velocities ...............................
-		for (int J=0; J<3; J++)	{
-			for (int I=0; I<NFFT; I++)  
-			{			    					// put data into input vector
-				cx_in[I].r = real(UC[I][J]);    	// real component - kiss_fft likes floats
-				cx_in[I].i = imag(UC[I][J]);    	// imaginary component
-			}
-			kiss_fft( cfg , cx_in , cx_out );     	// do the IFFT
-			
-			for (int I=0; I<NFFT; I++)  UTS[i][I][J] = cx_out[I].r /(float)Nw;   // copy out the IFFT data to the time series
-		}
-		
-		// if (wordy) if (i==N) for (int I=0; I<NFFT; I++) cout << "   UTSx is " << UTS[i][I][0] << " at time " << tTS[I] << endl;
+	// ----------------------------- write to text file for debugging ----------------------------
+	if ((wordy>1) && (number == 1))
+	{
+		vector< vector< floatC > > spec(7, vector< floatC >(Nw, 0.));
+		waveSpectra(N, spec);
 		
-		// .............................. wave accelerations ...............................
-		for (int J=0; J<3; J++)	{
-			for (int I=0; I<NFFT; I++)  
-			{			    					// put data into input vector
-				cx_in[I].r = real(UdC[I][J]);    	// real component - kiss_fft likes floats
-				cx_in[I].i = imag(UdC[I][J]);    	// imaginary component
-			}
-			kiss_fft( cfg , cx_in , cx_out );     	// do the IFFT
-			
-			for (int I=0; I<NFFT; I++)  UdTS[i][I][J] = cx_out[I].r /(float)Nw;   // copy out the IFFT data to the time series
-		}
+		ofstream waveoutsC("wavesC.out");
+		waveoutsC << "wave data output file" << endl << endl;
 		
+		waveoutsC << "w \t k \t zetaC0r \t zetaC0i \t zetaCr \t zetaCi \t UCxr  \t UCxi \t UCzr \t UCzi \n";
+		for (int j=0; j<NFFT; j++)  waveoutsC << w[j] << " \t" << k[j] << " \t" << real(zetaC0[j]) << " \t" << imag(zetaC0[j]) << 
+		   " \t" << real(spec[0][j]) << " \t" << imag(spec[0][j]) << " \t" << real(spec[1][j]) << " \t" << imag(spec[1][j]) << 
+		   " \t" << real(spec[3][j]) << " \t" << imag(spec[3][j]) << endl;	
+		waveoutsC.close();
 		
-		// ----------------------------- write to text file for debugging ----------------------------
-		if ((number == 1) && (i == N))
-		{
-			if (wordy>2)   cout << "   frequnecy domain starting wave data output file" << endl;
-			ofstream waveoutsC("wavesC.out");
-			waveoutsC << "wave data output file" << endl << endl;
-			
-			waveoutsC << "w \t k \t zetaC0r \t zetaC0i \t zetaCr \t zetaCi \t UCxr  \t UCxi \t UCzr \t UCzi \n";
-			for (int j=0; j<NFFT; j++)  waveoutsC << w[j] << " \t" << k[j] << " \t" << real(zetaC0[j]) << " \t" << imag(zetaC0[j]) << 
-			   " \t" << real(zetaC[j]) << " \t" << imag(zetaC[j]) << " \t" << real(UC[j][0]) << " \t" << imag(UC[j][0]) << 
-			   " \t" << real(UC[j][2]) << " \t" << imag(UC[j][2]) << endl;	
-			waveoutsC.close();
-		}
-		if (number==1)
+		for (int i=0; i<=N; i++)
 		{		
 			stringstream oname;
 			oname << "waves_i" << i << ".out";
@@ -774,21 +986,19 @@ void Line::makeWaveKinematics( double t0 )
 			waveouts << "wave data output file" << endl << endl;
 			
 			waveouts << "t \t zeta \t Ux \t Uz \t Udx \t Udz \n";
-			for (int j=0; j<NFFT; j++)  waveouts << tTS[j] << " \t" << zetaTS[i][j] << " \t" << UTS[i][j][0] << " \t" << UTS[i][j][2] << " \t" << UdTS[i][j][0] << " \t" << UdTS[i][j][2] << endl;	
+			for (int j=0; j<NFFT; j++)  
+			{
+				const float* wj = &waveTS[(j*(N+1) + i)*7];
+				waveouts << tTS[j] << " \t" << wj[0] << " \t" << wj[1] << " \t" << wj[3] << " \t" << wj[4] << " \t" << wj[6] << endl;	
+			}
 			waveouts.close();
 		}
-		
-		// wave stretching stuff would maybe go here...
-		
-	} // i done looping through nodes
-	
-	
-	//cout << "   about to free fft data structures." << endl;
+	}
 	
+	// wave stretching stuff would maybe go here...
 	
-	free(cx_in);
-	free(cx_out);
-	free(cfg);
+	if (env.WaveCache > 0)
+		writeWaveCache(waveHash);
 	
 	if (wordy>1) cout << "    done wave Kinematics" << endl;
 };
@@ -803,6 +1013,24 @@ void Line::scaleDrag(double scaler)
 	return;
 }
 
+// kinetic energy of the line's internal nodes for the states X (used for kinetic damping during IC generation)
+double Line::getKineticEnergy(const double* X)
+{
+	double KE = 0.0;
+	for (int i=1; i<N; i++)
+	{
+		double m = 0.5*rho*pi/4.*d*d*(l[i-1] + l[i]);	// node mass (without added mass)
+		for (int J=0; J<3; J++)  KE += 0.5*m*X[3*i-3 + J]*X[3*i-3 + J];
+	}
+	return KE;
+}
+
+// set the internal node velocities in the states X to zero (kinetic damping reset)
+void Line::zeroVelocities(double* X)
+{
+	for (int i=0; i<3*(N-1); i++)  X[i] = 0.0;
+}
+
 // function to reset time after IC generation
 void Line::setTime(double time)
 {
@@ -817,9 +1045,11 @@ void Line::doRHS( const double* X,  double* Xd, const double time,  double dt)
 {
 	t = time;
 
-	// set end node positions and velocities from connect objects' states
-	AnchConnect->getConnectState(r[0],rd[0]);
-	FairConnect->getConnectState(r[N],rd[N]);
+	ProfScope pKin(profile ? &prof[LPROF_KIN] : NULL);
+	
+	// set end node positions and velocities from connect objects' states (interpolated in time if this line is sub-cycled)
+	AnchConnect->getConnectState(time, r[0],rd[0]);
+	FairConnect->getConnectState(time, r[N],rd[N]);
 
 	// set interior node positions and velocities
 	for (int i=1; i<N; i++) 
@@ -853,9 +1083,13 @@ void Line::doRHS( const double* X,  double* Xd, const double time,  double dt)
 	}
 
 	
+	pKin.stop();
+	
 	//============================================================================================
 	// --------------------------------- apply wave kinematics ------------------------------------
 	
+	ProfScope pWaves(profile ? &prof[LPROF_WAVES] : NULL);
+	
 	if (WaveKin == 0)   // if Wave Kinematics haven't been calculated.   ...this is a local Line switch (so wave kinematics can be enabled/disabled for individual lines)
 	{
 		for (int i=0; i<=N; i++)
@@ -880,27 +1114,28 @@ void Line::doRHS( const double* X,  double* Xd, const double time,  double dt)
 		// =========== obtain (precalculated) wave kinematics at current time instant ============
 		// get precalculated wave kinematics at previously-defined node positions for time instant t
 		
-		// get interpolation constant and wave time step index
-		double frac;
-		for (int ts=0; ts<Nt-1; ts++)			// loop through precalculated wave time series time steps  (start ts at ts0 to save time)
-		{	if (tTS[ts+1] > t) 				// moving precalculated time bracked "up".  Stop once upper end of bracket is greater than current time t.
-			{
-				ts0 = ts;
-				frac = ( t - tTS[ts] )/( tTS[ts+1] - tTS[ts] );
-				break;
-			}
-		}
+		// get interpolation constant and wave time step index (uniform time steps, so directly)
+		ts0 = floor((t - tTS[0])/WaveDT);
+		ts0 = max(0, min(ts0, Nt-2));
+		double frac = ( t - tTS[ts0] )/WaveDT;
+		
+		// generate the next window of kinematics if lazily generated and t has moved past the current one
+		if ((ts0 < tsWin0) || (ts0 + 1 >= tsWin0 + NtWin))
+			makeWaveWindow(ts0);
+		
+		const float* w0 = &waveTS[(ts0 - tsWin0)*(N+1)*7];	// kinematics of all nodes at the bracketing time steps
+		const float* w1 = w0 + (N+1)*7;
 				
 		// loop through nodes 
 		for (int i=0; i<=N; i++)
 		{
-			zeta[i] = zetaTS[i][ts0] + frac*( zetaTS[i][ts0+1] - zetaTS[i][ts0] );			
-			F[i] = 1.0;   // FTS[i][ts0] + frac*(FTS[i][ts0+1] - FTS[i][ts0]);
+			zeta[i] = w0[7*i] + frac*( w1[7*i] - w0[7*i] );			
+			F[i] = 1.0;
 			
 			for (int J=0; J<3; J++)
 			{
-				U[i][J] = UTS[i][ts0][J] + frac*( UTS[i][ts0+1][J] - UTS[i][ts0][J] );				
-				Ud[i][J] = UdTS[i][ts0][J] + frac*( UdTS[i][ts0+1][J] - UdTS[i][ts0][J] );
+				U[i][J] = w0[7*i+1+J] + frac*( w1[7*i+1+J] - w0[7*i+1+J] );				
+				Ud[i][J] = w0[7*i+4+J] + frac*( w1[7*i+4+J] - w0[7*i+4+J] );
 			}
 			
 //			if (wordy) {
@@ -915,9 +1150,12 @@ void Line::doRHS( const double* X,  double* Xd, const double time,  double dt)
 			if (number==1)
 				  cout << " t=" << t << ", U[4][0]=" << U[4][0] << endl;
 	}
+	pWaves.stop();
 	//============================================================================================
 	
     // calculate mass matrix 
+	ProfScope pMass(profile ? &prof[LPROF_MASS] : NULL);
+	
 	for (int i=0; i<=N; i++) 
 	{
 		double m_i; // node mass
@@ -948,8 +1186,32 @@ void Line::doRHS( const double* X,  double* Xd, const double time,  double dt)
 		
 		inverse3by3(S[i], M[i]);	// invert node mass matrix (written to S[i][:][:])	
 	}
+	pMass.stop();
 	
+	//------------------------- SYNCOM Modifications---------------------------------
+	// Multi-rate mode: decide whether the SYNCOM state is advanced in this call. Between updates
+	// the stress is extrapolated from the last committed state with the frozen tangent.
+	int SCupdate = 1;
+	if (viscoE && !switchInit) {
+		SCdtAcc += dt;
+		SCcount++;
+		if ((SCrate > 1) || (SCdEps > 0.0)) {
+			SCupdate = ((SCrate > 1) && (SCcount >= SCrate));
+			if (!SCupdate && (SCdEps > 0.0)) {
+				for (int i = 0; i < N; i++) {
+					if (fabs((lstr[i] - l[i]) / l[i] - stressCalc->get_epsim1(i)) > SCdEps) {
+						SCupdate = 1;
+						break;
+					}
+				}
+			}
+		}
+	}
+	//---------------------------- End Modifications---------------------------------
+
 	// ============  CALCULATE FORCES ON EACH NODE ===============================
+	ProfScope pSegs(profile ? &prof[LPROF_SEGS] : NULL);
+	
 	// loop through the segments
 	for (int i = 0; i < N; i++)
 	{
@@ -961,11 +1223,13 @@ void Line::doRHS( const double* X,  double* Xd, const double time,  double dt)
 				for (int J = 0; J < 3; J++) {
 					T[i][J] = E * pi / 4. * d * d * (1. / l[i] - 1. / lstr[i]) * (r[i + 1][J] - r[i][J]);
 				}
+				EAt[i] = E * pi / 4. * d * d;
 			}
 			else {
 				for (int J = 0; J < 3; J++) {
 					T[i][J] = 0.;	// cable can't "push"
 				}
+				EAt[i] = 0.;
 			}
 
 			// line internal damping force
@@ -988,9 +1252,12 @@ void Line::doRHS( const double* X,  double* Xd, const double time,  double dt)
 					for (int J = 0; J < 3; J++) {
 						T[i][J] = (r[i + 1][J] - r[i][J]) / lstr[i] * pi / 4. * d * d * stress_SC * stressCalc->material_props->MBL;
 					}
+					EAt[i] = stressCalc->get_stiff(i) * pi / 4. * d * d;
 				}
-				else
+				else {
 					for (int J = 0; J < 3; J++)  T[i][J] = 0.0;	// cable can't "push"
+					EAt[i] = 0.0;
+				}
 
 				// line internal damping force;
 				for (int J = 0; J < 3; J++)  Td[i][J] = c * pi / 4. * d * d * (ldstr[i] / l[i]) * (r[i + 1][J] - r[i][J]) / lstr[i];
@@ -998,22 +1265,42 @@ void Line::doRHS( const double* X,  double* Xd, const double time,  double dt)
 			else {
 				if (lstr[i] / l[i] > 1.0) {
 					double strain = (lstr[i] - l[i]) / l[i];
-					errCodes = stressCalc->syncom_solver(i, dt, strain, stress_SC);
-
-					//cout << i << "      " << strain << "        " << stressCalc->get_sigmaim1(i) << endl;
-					/// Check SynCOM output status.
-					if (errCodes != rope::ErrorCode::SUCCESS)
-					{
-						print_log(*stressCalc, errCodes, errorOut);
-						cout << "\n Syncom NAN outputs. Check SynCOM_log for details. \n" << endl;
-						return;
+					if (SCupdate) {
+						ProfScope pSC(profile ? &prof[LPROF_SYNCOM] : NULL);
+						errCodes = stressCalc->syncom_solver(i, SCdtAcc, strain, stress_SC);
+						pSC.stop();
+						if (profile)
+						{
+							if (stressCalc->get_reused())
+								SCreused++;
+							else
+								newtonHist[min(stressCalc->get_nIter(), LPROF_NITER-1)]++;
+						}
+
+						//cout << i << "      " << strain << "        " << stressCalc->get_sigmaim1(i) << endl;
+						/// Check SynCOM output status.
+						if (errCodes != rope::ErrorCode::SUCCESS)
+						{
+							print_log(*stressCalc, errCodes, errorOut);
+							cout << "\n Syncom NAN outputs. Check SynCOM_log for details. \n" << endl;
+							return;
+						}
+					}
+					else {
+						// linearized about the last committed state using the tangent of the last solve
+						stress_SC = stressCalc->get_sigmaim1(i) + stressCalc->get_stiff(i) / stressCalc->material_props->MBL
+							* (strain - stressCalc->get_epsim1(i));
+						if (stress_SC < 0.0) stress_SC = 0.0;
 					}
 					for (int J = 0; J < 3; J++) {
 						T[i][J] = (r[i + 1][J] - r[i][J]) / lstr[i] * pi / 4. * d * d * stress_SC * stressCalc->material_props->MBL;
 					}
+					EAt[i] = stressCalc->get_stiff(i) * pi / 4. * d * d;
 				}
-				else
+				else {
 					for (int J = 0; J < 3; J++)  T[i][J] = 0.0;	// cable can't "push"
+					EAt[i] = 0.0;
+				}
 
 				// line internal damping force;
 				for (int J = 0; J < 3; J++)  Td[i][J] = c * pi / 4. * d * d * (ldstr[i] / l[i]) * (r[i + 1][J] - r[i][J]) / lstr[i];
@@ -1022,7 +1309,11 @@ void Line::doRHS( const double* X,  double* Xd, const double time,  double dt)
 		}
 	}
 
+	pSegs.stop();
+	
 	// loop through the nodes
+	ProfScope pNodes(profile ? &prof[LPROF_NODES] : NULL);
+	
 	for (int i=0; i<=N; i++)
 	{
 		// submerged weight (including buoyancy)
@@ -1112,7 +1403,11 @@ void Line::doRHS( const double* X,  double* Xd, const double time,  double dt)
 	}
 		
 		
+	pNodes.stop();
+	
 	// loop through internal nodes and update their states
+	ProfScope pStates(profile ? &prof[LPROF_STATES] : NULL);
+	
 	for (int i=1; i<N; i++)	
 	{
 		// calculate RHS constant (premultiplying force vector by inverse of mass matrix  ... i.e. rhs = S*Forces)	
@@ -1129,9 +1424,11 @@ void Line::doRHS( const double* X,  double* Xd, const double time,  double dt)
 	}
 
 	//------------------------- SYNCOM Modifications---------------------------------
-	// Updates instantaneous parameter values; 
-	if (viscoE && !switchInit) {
-		SC_updateParams(dt);
+	// Updates instantaneous parameter values (only on SYNCOM update calls in multi-rate mode); 
+	if (viscoE && !switchInit && SCupdate) {
+		SC_updateParams(SCdtAcc);
+		SCdtAcc = 0.0;
+		SCcount = 0;
 	}
 	//---------------------------- End Modifications---------------------------------
 
@@ -1139,78 +1436,186 @@ void Line::doRHS( const double* X,  double* Xd, const double time,  double dt)
 };
 
 
+// Advances the line's internal node states X by one RK2 step of its own size dt, starting at time.
+// Used for local time stepping, where the end kinematics come from the connections' synchronization interval.
+void Line::stepRK2( double* X, const double time, double dt)
+{
+	int nX = 6*(N-1);
+	
+	doRHS(X, &Xd0[0], time, 0.5*dt);
+	
+	for (int i=0; i<nX; i++) 
+		Xt[i] = X[i] + 0.5*dt*Xd0[i];
+	
+	doRHS(&Xt[0], &Xd1[0], time + 0.5*dt, 0.5*dt);
+	
+	for (int i=0; i<nX; i++) 
+		X[i] = X[i] + dt*Xd1[i];
+	
+	return;
+};
+
+
+// advance the internal node states by one semi-implicit (linearly implicit) Euler step.
+// The axial stiffness (using the tangent EAt from the last doRHS call, i.e. the SYNCOM tangent for viscoE lines),
+// the geometric stiffness and the internal damping of each segment are treated implicitly, which gives a
+// block-tridiagonal system in the internal node velocity increments:
+//   (M - dt*C - dt^2*K) dv = dt*(Fnet + dt*K*v)
+// Everything else (drag, weight, bottom contact, added mass forcing) stays explicit.  Must be called right
+// after doRHS at the start of the step, since it uses the forces, mass matrices and kinematics stored there.
+void Line::stepSemiImplicit( double* X, double dt)
+{
+	int n = N-1;  // number of internal nodes
+	if (n < 1) return;
+
+	// segment stiffness (dT/dr) and combined dt*C + dt^2*K blocks
+	for (int i=0; i<N; i++)
+	{
+		double qs[3];
+		for (int J=0; J<3; J++)  qs[J] = (r[i+1][J] - r[i][J])/lstr[i];
+
+		double Tm = sqrt(T[i][0]*T[i][0] + T[i][1]*T[i][1] + T[i][2]*T[i][2]);
+		double kax  = EAt[i]/l[i];						// axial tangent stiffness
+		double kgeo = Tm/lstr[i];						// geometric (transverse) stiffness
+		double cax  = c*pi/4.*d*d/l[i];					// axial internal damping
+
+		for (int I=0; I<3; I++) {
+			for (int J=0; J<3; J++) {
+				double qq = qs[I]*qs[J];
+				Kseg [9*i + 3*I + J] = kax*qq + kgeo*(eye(I,J) - qq);
+				KCseg[9*i + 3*I + J] = dt*cax*qq + dt*dt*Kseg[9*i + 3*I + J];
+			}
+		}
+	}
+
+	// assemble block rows for internal nodes 1..N-1 (the end nodes are prescribed by their connections)
+	for (int i=1; i<N; i++)
+	{
+		int j = i-1;  // block row
+
+		for (int I=0; I<3; I++) {
+			for (int J=0; J<3; J++) {
+				Jdiag[9*j + 3*I + J] = M[i][I][J] + KCseg[9*(i-1) + 3*I + J] + KCseg[9*i + 3*I + J];
+				Jsub [9*j + 3*I + J] = -KCseg[9*(i-1) + 3*I + J];
+				Jsup [9*j + 3*I + J] = -KCseg[9*i + 3*I + J];
+			}
+		}
+
+		for (int I=0; I<3; I++) {
+			double Kv = 0.0;
+			for (int J=0; J<3; J++)
+				Kv += Kseg[9*(i-1) + 3*I + J]*(rd[i-1][J] - rd[i][J]) + Kseg[9*i + 3*I + J]*(rd[i+1][J] - rd[i][J]);
+			Jrhs[3*j + I] = dt*(Fnet[i][I] + dt*Kv);
+		}
+	}
+
+	solveBlockTridiag3(n, &Jsub[0], &Jdiag[0], &Jsup[0], &Jrhs[0]);  // velocity increments written to Jrhs
+
+	// update velocities, then positions with the new velocities
+	for (int i=1; i<N; i++)
+	{
+		for (int J=0; J<3; J++)
+		{
+			X[        3*i-3 + J] += Jrhs[3*(i-1) + J];			// velocities
+			X[3*N-3 + 3*i-3 + J] += dt*X[3*i-3 + J];			// positions
+		}
+	}
+
+	return;
+};
+
+
+
+// number of values in each output row of this line (including time)
+int Line::getOutputSize()
+{
+	int n = 1;
+	if (outFlags & OUT_POS)     n += 3*(N+1);
+	if (outFlags & OUT_VEL)     n += 3*(N+1);
+	if (outFlags & OUT_WAVEU)   n += 3*(N+1);
+	if (outFlags & OUT_DRAG)    n += 3*(N+1);
+	if (outFlags & OUT_TEN)     n += N;
+	if (outFlags & OUT_DAMP)    n += 3*N;
+	if (outFlags & OUT_STRAIN)  n += N;
+	if (outFlags & OUT_STRRATE) n += N;
+	return n;
+};
+
+void Line::setOutputWriter(OutputWriter* outWriter_in)
+{
+	outWriter = outWriter_in;
+};
 
 // write output file for line  (accepts time parameter since retained time value (t) will be behind by one line time step
+// snapshot the flagged output channels into the next row of the output writer
 void Line::Output(double time)
 {
 	// run through output flags
-	// if channel is flagged for output, write to file.
+	// if channel is flagged for output, copy it to the output row.
 	// Flags changed to just be one character (case sensitive) per output flag.  To match FASTv8 version.
 		
-	if (outfile) // if not a null pointer (indicating no output)
+	if (outWriter) // if not a null pointer (indicating no output)
 	{
-		if (outfile->is_open())
-		{
-			// output time
-			*outfile << time << "\t "; 
+		double* row = outWriter->beginRow();
+		int n = 0;
 		
-			// output positions?
-			//if (find(channels.begin(), channels.end(), "position") != channels.end())
-			if (channels.find("p") != string::npos)
+		// output time
+		row[n++] = time; 
+	
+		// output positions?
+		if (outFlags & OUT_POS)
+		{
+			for (int i=0; i<=N; i++)	//loop through nodes
 			{
-				for (int i=0; i<=N; i++)	//loop through nodes
-				{
-					for (int J=0; J<3; J++)  *outfile << r[i][J] << "\t ";
-				}
+				for (int J=0; J<3; J++)  row[n++] = r[i][J];
 			}
-			// output velocities?
-			if (channels.find("v") != string::npos) {
-				for (int i=0; i<=N; i++)  {
-					for (int J=0; J<3; J++)  *outfile << rd[i][J] << "\t ";
-				}
+		}
+		// output velocities?
+		if (outFlags & OUT_VEL) {
+			for (int i=0; i<=N; i++)  {
+				for (int J=0; J<3; J++)  row[n++] = rd[i][J];
 			}
-			// output wave velocities?
-			if (channels.find("u") != string::npos) {
-				for (int i=0; i<=N; i++)  {
-					for (int J=0; J<3; J++)  *outfile << U[i][J] << "\t ";
-				}
+		}
+		// output wave velocities?
+		if (outFlags & OUT_WAVEU) {
+			for (int i=0; i<=N; i++)  {
+				for (int J=0; J<3; J++)  row[n++] = U[i][J];
 			}
-			// output hydro drag force?
-			if (channels.find("D") != string::npos) {
-				for (int i=0; i<=N; i++)  {
-					for (int J=0; J<3; J++)  *outfile << Dp[i][J] + Dq[i][J] + Ap[i][J] + Aq[i][J] << "\t ";
-				}
+		}
+		// output hydro drag force?
+		if (outFlags & OUT_DRAG) {
+			for (int i=0; i<=N; i++)  {
+				for (int J=0; J<3; J++)  row[n++] = Dp[i][J] + Dq[i][J] + Ap[i][J] + Aq[i][J];
 			}
-			// output segment tensions?
-			if (channels.find("t") != string::npos) {
-				for (int i=0; i<N; i++)  {
-					double Tmag_squared = 0.; 
-					for (int J=0; J<3; J++)  Tmag_squared += T[i][J]*T[i][J]; // doing this calculation here only, for the sake of speed
-					*outfile << sqrt(Tmag_squared) << "\t ";
-				}
+		}
+		// output segment tensions?
+		if (outFlags & OUT_TEN) {
+			for (int i=0; i<N; i++)  {
+				double Tmag_squared = 0.; 
+				for (int J=0; J<3; J++)  Tmag_squared += T[i][J]*T[i][J]; // doing this calculation here only, for the sake of speed
+				row[n++] = sqrt(Tmag_squared);
 			}
-			// output internal damping force?
-			if (channels.find("c") != string::npos) {
-				for (int i=0; i<N; i++)  {
-					for (int J=0; J<3; J++)  *outfile << Td[i][J] + Td[i][J] + Td[i][J] << "\t ";
-				}
+		}
+		// output internal damping force?
+		if (outFlags & OUT_DAMP) {
+			for (int i=0; i<N; i++)  {
+				for (int J=0; J<3; J++)  row[n++] = Td[i][J] + Td[i][J] + Td[i][J];
 			}
-			// output segment strains?
-			if (channels.find("s") != string::npos) {
-				for (int i=0; i<N; i++)  {
-					*outfile << lstr[i]/l[i]-1.0 << "\t ";
-				}
+		}
+		// output segment strains?
+		if (outFlags & OUT_STRAIN) {
+			for (int i=0; i<N; i++)  {
+				row[n++] = lstr[i]/l[i]-1.0;
 			}
-			// output segment strain rates?
-			if (channels.find("d") != string::npos) {
-				for (int i=0; i<N; i++)  {
-					*outfile << ldstr[i]/l[i] << "\t ";
-				}
+		}
+		// output segment strain rates?
+		if (outFlags & OUT_STRRATE) {
+			for (int i=0; i<N; i++)  {
+				row[n++] = ldstr[i]/l[i];
 			}
-			
-			*outfile << "\n";
 		}
-		else cout << "Unable to write to output file " << endl;
+		
+		outWriter->commitRow();
 	}
 	return;
 };
@@ -1237,11 +1642,97 @@ void Line::SC_updateParams(double dt) {
 		stressCalc->updateParams(N, dt);
 }
 
+void Line::SC_setMultiRate(int SCrateIn, double SCdEpsIn) {
+	SCrate = SCrateIn;
+	SCdEps = SCdEpsIn;
+	SCcount = 0;
+	SCdtAcc = 0.0;
+}
+
+// reuse of SYNCOM evaluations for segments whose strain has not changed by more than SCskipTolIn
+void Line::SC_setSkip(double SCskipTolIn, int SCskipMaxIn) {
+	if (viscoE)
+		stressCalc->set_skip(SCskipTolIn, SCskipMaxIn);
+}
+
 void Line::SC_getEpsFL(double* epsFL) {
 	if (viscoE)
 		*(epsFL) = stressCalc->get_eps(N-1);
 }
 
+// SYNCOM segment quantities of the last update (stresses normalized by the MBL; zero for non-SYNCOM lines)
+void Line::SC_getSegStress(double* out) {
+	for (int i = 0; i < N; i++)
+		out[i] = viscoE ? stressCalc->get_sigmaim1(i) : 0.0;
+}
+
+void Line::SC_getSegEpsVP(double* out) {
+	for (int i = 0; i < N; i++)
+		out[i] = viscoE ? stressCalc->get_eps_vp(i) : 0.0;
+}
+
+void Line::SC_getSegSigmaYield(double* out) {
+	for (int i = 0; i < N; i++)
+		out[i] = viscoE ? stressCalc->get_sigma_yield(i) : 0.0;
+}
+
+string Line::SC_getInputFile(void) {
+	if (viscoE)
+		return inputPath(outDir, input_fileSC);
+	return "";
+}
+
+void Line::SC_saveState(ostream& out) {
+	if (viscoE)
+		stressCalc->saveState(out);
+}
+
+int Line::SC_loadState(istream& in) {
+	if (viscoE)
+		return stressCalc->loadState(in);
+	return 0;
+}
+
+int Line::SC_checkState(istream& in) {
+	if (viscoE)
+		return stressCalc->checkState(in);
+	return 0;
+}
+
+// save/restore the line time, the multi-rate SYNCOM counters and the SYNCOM histories (checkpoints).
+// The node states are part of the global state vector.
+void Line::saveState(ostream& out) {
+	out.write((char*)&t, sizeof(t));
+	out.write((char*)&SCcount, sizeof(SCcount));
+	out.write((char*)&SCdtAcc, sizeof(SCdtAcc));
+	SC_saveState(out);
+}
+
+int Line::loadState(istream& in) {
+	in.read((char*)&t, sizeof(t));
+	in.read((char*)&SCcount, sizeof(SCcount));
+	in.read((char*)&SCdtAcc, sizeof(SCdtAcc));
+	if (!in)
+		return 1;
+	return SC_loadState(in);
+}
+
+// check a section written by saveState against this line without loading it
+int Line::checkState(istream& in) {
+	in.ignore(sizeof(t) + sizeof(SCcount) + sizeof(SCdtAcc));
+	if (!in)
+		return 1;
+	return SC_checkState(in);
+}
+
+// number of bytes written by saveState
+size_t Line::getStateSize() {
+	size_t n = sizeof(t) + sizeof(SCcount) + sizeof(SCdtAcc);
+	if (viscoE)
+		n += stressCalc->stateSize();
+	return n;
+}
+
 void Line::SC_clear(void) {
 	if (viscoE) {
 		delete mat_props;
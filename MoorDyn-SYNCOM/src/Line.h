@@ -21,6 +21,7 @@
 #include "SynCOM.h"
 #include "SC_error.h"
 #include "SC_stressSolver_api.h"
+#include "Profiler.h"
 #include <iomanip>
 
 using namespace std;
@@ -29,6 +30,17 @@ using namespace std;
 //   [connect (node 0)]  --- segment 0 --- [ node 1 ] --- seg 1 --- [node2] --- ... --- seg n-2 --- [node n-1] --- seg n-1 ---  [connect (node N)]
 
 class Connection;
+class OutputWriter;
+
+// line output channel flags (the channels string is parsed once into a bitmask of these)
+const int OUT_POS     = 1;		// "p" node positions
+const int OUT_VEL     = 2;		// "v" node velocities
+const int OUT_WAVEU   = 4;		// "u" wave velocities at nodes
+const int OUT_DRAG    = 8;		// "D" hydrodynamic drag and added mass forces at nodes
+const int OUT_TEN     = 16;		// "t" segment tensions
+const int OUT_DAMP    = 32;		// "c" segment internal damping forces
+const int OUT_STRAIN  = 64;		// "s" segment strains
+const int OUT_STRRATE = 128;	// "d" segment strain rates
 
 class Line 
 {
@@ -95,6 +107,21 @@ class Line
 	
 	vector<double> V;		// line segment volume
 
+	vector<double> EAt;		// segment axial tangent stiffness (N) - E*A for linear lines, from SYNCOM otherwise
+	
+	// work arrays for the semi-implicit integrator (flat 3x3 blocks)
+	vector<double> Kseg;	// segment stiffness blocks dT/dr
+	vector<double> KCseg;	// segment blocks dt*C + dt^2*K
+	vector<double> Jsub;	// sub-diagonal blocks of the internal node system
+	vector<double> Jdiag;	// diagonal blocks
+	vector<double> Jsup;	// super-diagonal blocks
+	vector<double> Jrhs;	// right hand side / velocity increments
+	
+	// work arrays for local (per-line) RK2 time stepping
+	vector<double> Xd0;
+	vector<double> Xt;
+	vector<double> Xd1;
+
 	//===============================================================================
 	//------------------------- SYNCOM Modifications---------------------------------
 	// Set work folder and input files. 
@@ -102,13 +129,23 @@ class Line
 	rope::stressSolver* stressCalc;
 	rope::ErrorCode errCodes;
 	rope::ErrorOut errorOut;
-	string input_fileSC = "MaterDef.xml";
+	string input_fileSC = "MaterDef.xml";	// read from the folder of the system's input file (outDir), else the working folder
 	int flagSC = 0;
 	int switchInit = 1;
 	double stress_SC;
+	int SCrate = 1;			// multi-rate: max number of RHS calls between SYNCOM updates (1 = update every call)
+	double SCdEps = 0.0;		// multi-rate: strain increment that forces a SYNCOM update (0 = off)
+	int SCcount = 0;		// RHS calls since the last SYNCOM update
+	double SCdtAcc = 0.0;		// time elapsed since the last SYNCOM update
 
 	//----------------------End SYNCOM Modifications---------------------------------
 	
+	// profiling (see Profiler.h)
+	int profile = 0;				// flag to time the sections of doRHS
+	ProfTimer prof[LPROF_NLINE];		// timers of the doRHS sections
+	long newtonHist[LPROF_NITER];		// histogram of the Newton iterations per SYNCOM solve
+	long SCreused;				// number of SYNCOM evaluations reused for quiescent segments
+	
 	// set up output arrays, at each node i:
 	vector< vector< double > >  U;     // wave velocities	
 	vector< vector< double > >  Ud;     // wave accelerations
@@ -118,7 +155,10 @@ class Line
 	// file stuff
 	
 	ofstream * outfile; // if not a pointer, caused odeint system initialization error during compilation
+	OutputWriter * outWriter;	// buffered background writer for this line's output (NULL if none)
+	int outFlags;			// bitmask of OUT_ flags from the channels string
 	string channels;
+	string outDir;			// folder of the system's input file (wave cache and SYNCOM files)
 	
 	// new additions for handling waves in-object and precalculating them	(not necessarily used right now)
 	int WaveMod;
@@ -146,14 +186,14 @@ class Line
 	vector< double > Ucurrent; // constant uniform current to add (three components)
 	
 	// new additions for precalculating wave quantities
-	vector< vector< double > > zetaTS;   // time series of wave elevations above each node
-	vector< vector< double > > FTS;
-	vector< vector< vector< double > > > UTS;
-	vector< vector< vector< double > > > UdTS;
+	vector< float > waveTS;	// wave kinematics time series, time-major: [ts][node][zeta, Ux, Uy, Uz, Udx, Udy, Udz]
+	int tsWin0;			// first wave time step held in waveTS
+	int NtWin;			// number of wave time steps held in waveTS (Nt unless generated lazily in windows)
 	int Nt; 				// number of wave time steps
 	double WaveDT; 		// wave time step size (s)
 	vector< double > tTS; 	// time step vector
 	int ts0; 				// time step index used for interpolating wave kinematics time series data (put here so it's persistent)
+	vector< vector< double > > rWave;	// node positions the wave kinematics are computed at (set in makeWaveKinematics)
 	
 
 public:
@@ -167,11 +207,17 @@ public:
  
 	int getN(); // returns N (number of segments)
 	
+	double getStableDt(); // returns the CFL-limited time step (s) from the axial wave speed
+	
 	void setup(int number, LineProps props_in, double UnstrLen_in, int NumNodes, 
 		Connection& AnchConnect_in, Connection& FairConnect_in,
-		shared_ptr<ofstream> outfile_pointer, string channels_in);
+		shared_ptr<ofstream> outfile_pointer, string channels_in, string outDir_in);
 	
 	void initialize( double* X );
+	
+	double getKineticEnergy(const double* X);
+	
+	void zeroVelocities(double* X);
 
 	double getNodeTen(int i);
 	
@@ -179,8 +225,25 @@ public:
 
 	int getNodePos_v2(int NodeNum, double* pos);
 	
+	// bulk accessors (flat arrays: 3*(N+1) values for node quantities, N values for segment quantities)
+	void getNodePositions(double* out);
+	
+	void getNodeVelocities(double* out);
+	
+	void getSegTensions(double* out);
+	
+	void getSegStrains(double* out);
+	
 	double GetLineOutput(OutChanProps outChan);
 	
+	void setProfile(int profileIn);
+	
+	const ProfTimer* getProfile();
+	
+	const long* getNewtonHist();
+	
+	long getSCreused();
+	
 	void getFASTtens(float* FairHTen, float* FairVTen, float* AnchHTen, float* AnchVTen);
 	
 	void getAnchStuff(vector<double> &Fnet_out, vector< vector<double> > &M_out);
@@ -192,6 +255,12 @@ public:
 	
 	void setupWaves(EnvCond env_in, vector<floatC> zetaC_in,  double WaveDOmega_in, double dt_in );
 	
+	void waveSpectra(int i, vector< vector< floatC > > &spec);
+	void setWaveTS(int i, int ts, int s, double val);
+	void makeWaveWindow(int tsStart);
+	uint64_t waveKinHash( double t0 );
+	int readWaveCache( uint64_t waveHash );
+	void writeWaveCache( uint64_t waveHash );
 	void makeWaveKinematics( double t0 );
 		
 	void scaleDrag(double scaler);
@@ -199,17 +268,51 @@ public:
 	void setTime(double time);
 	
 	void doRHS( const double* X,  double* Xd, const double time, double dt);
+	
+	void stepSemiImplicit( double* X, double dt);
+	
+	void stepRK2( double* X, const double time, double dt);
 
 	//void initiateStep(vector<double> &rFairIn, vector<double> &rdFairIn, double time);
 		
+	int getOutputSize();
+	
+	void setOutputWriter(OutputWriter* outWriter_in);
+	
 	void Output(double );
 
 	void SC_offInit(void);			// SC function;
 
 	void SC_updateParams(double dt);		// SC function;
 
+	void SC_setMultiRate(int SCrateIn, double SCdEpsIn);	// SC function;
+
+	void SC_setSkip(double SCskipTolIn, int SCskipMaxIn);	// SC function;
+
 	void SC_getEpsFL(double* epsFL);	// SC function;
 
+	void SC_getSegStress(double* out);	// SC function;
+
+	void SC_getSegEpsVP(double* out);	// SC function;
+
+	void SC_getSegSigmaYield(double* out);	// SC function;
+
+	string SC_getInputFile(void);		// SC function;
+
+	void SC_saveState(ostream& out);	// SC function;
+
+	int SC_loadState(istream& in);		// SC function;
+
+	int SC_checkState(istream& in);		// SC function;
+
+	void saveState(ostream& out);
+	
+	int loadState(istream& in);
+	
+	int checkState(istream& in);
+	
+	size_t getStateSize();
+
 	void SC_clear(void);			// SC function;
 
 #ifdef USEGL	
@@ -15,6 +15,7 @@
  */
 
 #include "Misc.h"
+#include <mutex>
 
 using namespace std;
 
@@ -415,6 +416,131 @@ void free2Darray(double** theArray, int arraySizeX)
 }
 
 
+// 3x3 helpers for flat (row major) matrices, used by the block tridiagonal solver below
+static void inverse3by3flat(double minv[9], const double m[9])
+{
+	double det = m[0]*(m[4]*m[8] - m[7]*m[5]) - m[1]*(m[3]*m[8] - m[5]*m[6]) + m[2]*(m[3]*m[7] - m[4]*m[6]);
+	double invdet = 1.0/det;
+
+	minv[0] = (m[4]*m[8] - m[7]*m[5])*invdet;
+	minv[1] = (m[2]*m[7] - m[1]*m[8])*invdet;
+	minv[2] = (m[1]*m[5] - m[2]*m[4])*invdet;
+	minv[3] = (m[5]*m[6] - m[3]*m[8])*invdet;
+	minv[4] = (m[0]*m[8] - m[2]*m[6])*invdet;
+	minv[5] = (m[3]*m[2] - m[0]*m[5])*invdet;
+	minv[6] = (m[3]*m[7] - m[6]*m[4])*invdet;
+	minv[7] = (m[6]*m[1] - m[0]*m[7])*invdet;
+	minv[8] = (m[0]*m[4] - m[3]*m[1])*invdet;
+}
+
+static void matmul3by3flat(double out[9], const double a[9], const double b[9])
+{
+	for (int I=0; I<3; I++)
+		for (int J=0; J<3; J++)
+			out[3*I+J] = a[3*I]*b[J] + a[3*I+1]*b[3+J] + a[3*I+2]*b[6+J];
+}
+
+
+// solve a block tridiagonal system of n block rows of 3x3 blocks using the block Thomas algorithm.
+// A holds the sub-diagonal blocks (A[0] unused), B the diagonal blocks and C the super-diagonal blocks
+// (C[n-1] unused), each as 9 row-major entries per block row.  d holds the right hand side (3 entries per
+// block row) and is overwritten with the solution.  B and C are overwritten in the process.
+void solveBlockTridiag3(int n, double* A, double* B, double* C, double* d)
+{
+	double Binv[9], tmp[9], dtmp[3];
+
+	// forward elimination
+	for (int k=0; k<n; k++)
+	{
+		double* Bk = B + 9*k;
+		double* dk = d + 3*k;
+
+		if (k > 0)
+		{
+			const double* Ak = A + 9*k;
+			matmul3by3flat(tmp, Ak, C + 9*(k-1));
+			for (int I=0; I<9; I++)  Bk[I] -= tmp[I];
+			for (int I=0; I<3; I++)  dk[I] -= Ak[3*I]*dk[-3] + Ak[3*I+1]*dk[-2] + Ak[3*I+2]*dk[-1];
+		}
+
+		inverse3by3flat(Binv, Bk);
+
+		if (k < n-1)
+		{
+			matmul3by3flat(tmp, Binv, C + 9*k);
+			for (int I=0; I<9; I++)  C[9*k+I] = tmp[I];
+		}
+		for (int I=0; I<3; I++)  dtmp[I] = Binv[3*I]*dk[0] + Binv[3*I+1]*dk[1] + Binv[3*I+2]*dk[2];
+		for (int I=0; I<3; I++)  dk[I] = dtmp[I];
+	}
+
+	// back substitution
+	for (int k=n-2; k>=0; k--)
+	{
+		const double* Ck = C + 9*k;
+		double* dk = d + 3*k;
+		for (int I=0; I<3; I++)  dk[I] -= Ck[3*I]*dk[3] + Ck[3*I+1]*dk[4] + Ck[3*I+2]*dk[5];
+	}
+}
+
+
+// path of an input file of a mooring system: dir + name if that exists, otherwise name in the working 
+// folder (where the classic single-system setups keep MaterDef.xml and waves.txt)
+string inputPath(const string& dir, const string& name)
+{
+	ifstream f((dir + name).c_str());
+	if (f.is_open())
+		return dir + name;
+	return name;
+}
+
+
+// 64-bit FNV-1a hash of a block of memory.  Pass the previous result as h to hash several blocks in sequence.
+uint64_t hashFNV1a(const void* data, size_t nBytes, uint64_t h)
+{
+	const unsigned char* bytes = (const unsigned char*)data;
+	for (size_t i=0; i<nBytes; i++)
+	{
+		h ^= bytes[i];
+		h *= 1099511628211ULL;
+	}
+	return h;
+}
+
+
+// shared kiss_fft plans, created once per size and direction and reused by all lines and nodes
+// (kiss_fft only reads the plan, so a plan can be used by several threads at once)
+// (the cache is shared by all mooring systems of the process, which may run in different threads)
+static map< pair<int,int>, kiss_fft_cfg > FFTplans;
+static mutex FFTplansMutex;
+
+kiss_fft_cfg getFFTplan(int nfft, int is_inverse_fft)
+{
+	lock_guard<mutex> lock(FFTplansMutex);
+	
+	kiss_fft_cfg cfg;
+	pair<int,int> key(nfft, is_inverse_fft);
+	map< pair<int,int>, kiss_fft_cfg >::iterator it = FFTplans.find(key);
+	if (it == FFTplans.end())
+	{
+		cfg = kiss_fft_alloc( nfft , is_inverse_fft ,0,0 );
+		FFTplans[key] = cfg;
+	}
+	else
+		cfg = it->second;
+	return cfg;
+}
+
+void freeFFTplans(void)
+{
+	lock_guard<mutex> lock(FFTplansMutex);
+	
+	for (map< pair<int,int>, kiss_fft_cfg >::iterator it = FFTplans.begin(); it != FFTplans.end(); ++it)
+		free(it->second);
+	FFTplans.clear();
+}
+
+
 
 
 
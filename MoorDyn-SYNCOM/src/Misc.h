@@ -30,6 +30,8 @@
 #include <cstring>
 
 #include <memory>
+#include <map>
+#include <stdint.h>
 
 #ifdef USEGL
  #include <GL/gl.h>  // for openGL drawing option
@@ -82,6 +84,8 @@ typedef struct
 	double cb;       // bottom damping
 	int WaveKin;	 // wave kinematics flag (0=off, >0=on)
 	int WriteUnits;	// a global switch for whether to show the units line in the output files (1, default), or skip it (0)
+	int WaveCache;	// flag to store/reuse precalculated wave kinematics on disk (0=off, 1=on)
+	double WaveWindow;	// length (s) of the window of wave kinematics generated at a time (0 = precalculate the whole time series)
 } EnvCond;
 
 
@@ -222,5 +226,14 @@ void doSSfilter(double* in, double* out, int dataSize, double* a, double* beta,
 double** make2Darray(int arraySizeX, int arraySizeY);
 void free2Darray(double** theArray, int arraySizeX);
 
+void solveBlockTridiag3(int n, double* A, double* B, double* C, double* d);
+
+uint64_t hashFNV1a(const void* data, size_t nBytes, uint64_t h = 14695981039346656037ULL);
+
+string inputPath(const string& dir, const string& name);
+
+kiss_fft_cfg getFFTplan(int nfft, int is_inverse_fft);
+void freeFFTplans(void);
+
 
 #endif
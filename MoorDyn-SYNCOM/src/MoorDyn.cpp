@@ -22,6 +22,10 @@
 #include "MoorDyn.h"
 #include "Line.h" 
 #include "Connection.h"
+#include "OutputWriter.h"
+#include "MoorDynSystem.h"
+
+#include <algorithm>
 
 #ifdef LINUX
 	#include <cmath> 	// already in misc.h?
@@ -31,56 +35,17 @@
 using namespace std;
 //using namespace rope;
 
-// static vectors for fairleads
-vector<double> FlinesS;					// net line force vector (6-DOF) - retains last solution for use when inputted dt is zero (such as during FAST predictor steps) when the model does not time step
-vector< vector< double > > rFairtS;		// fairlead locations in turbine/platform coordinates
-vector< vector< double > > rFairRel;		// fairlead locations relative to platform ref point but in inertial orientation
-double** rFairi;			// fairlead locations in inertial reference frame
-double** rdFairi;		// fairlead velocities in inertial reference frame
-
-// static vectors to hold line and connection objects
-vector< LineProps > LinePropList; 			// to hold line library types
-vector< Line > LineList; 				// line objects
-vector< Connection > ConnectList;			// connection objects (line joints or ends)
-int nLines;							// number of line objects
-int nConnects; 						// total number of Connection objects
-int nFairs  = 0;							// number of fairlead connections
-int nAnchs  = 0;							// number of anchor connections
-int nConns  = 0;							// number of "connect" connections
-
-vector< int > FairIs;  					// vector of fairlead connection indices in ConnectList vector
-vector< int > ConnIs;  					// vector of connect connection indices in ConnectList vector
-EnvCond env; 							// struct of general environmental parameters
-vector< shared_ptr< ofstream > > outfiles; 	// a vector to hold ofstreams for each line
-ofstream outfileMain;					// main output file
-vector< OutChanProps > outChans;		// list of structs describing selected output channels for main out file
 const char* UnitList[] = {"(s)     ", "(m)     ", "(m)     ", "(m)     ", 
                           "(m/s)   ", "(m/s)   ", "(m/s)   ", "(m/s2)  ",
 					 "(m/s2)  ", "(m/s2)  ", "(N)     ", "(N)     ",
-					 "(N)     ", "(N)     "};   // list of units for each of the QTypes (see misc.h)
-
-
-// state vector and stuff
-double* states; 						// pointer to array comprising global state vector
-int nX; 								// size of state vector array
-double* xt; 							// more state vector things for rk2/rk4 integration 
-double* f0;
-double* f1;
-//double* f2;
-//double* f3;
-
-double** Ffair;	// pointer to 2-d array holding fairlead forces
+					 "(N)     ", "(N)     "};
 
-vector< int > LineStateIs;  // vector of line starting indices in "states" array
+int nSystems = 0;		// number of initialized mooring systems (shared resources are freed with the last one)
+mutex nSystemsMutex;
 
-//double dt; // FAST time step
-double dtM0; // desired mooring line model time step   
+MoorDynSystem* defaultSystem = NULL;	// system used by the classic (non-handle) interface
 
-double dtOut = 0;  // (s) desired output interval (the default zero value provides output at every call to MoorDyn)
-
-// new temporary additions for waves
-vector< floatC > zetaCglobal;
-double dwW;
+const int stateVersion = 2;	// layout of the saved states (checkpoints and IC cache), 2: with the SYNCOM strain two steps back
 
 
 // new globals for creating output console window when needed
@@ -96,37 +61,63 @@ int OwnConsoleWindow = 0;
 #define isnan(x) std::isnan(x)     // contributed by Yi-Hsiang Yu at NREL
 #endif
 
+MoorDynSystem::MoorDynSystem(const char* inputFile_in)
+{
+	inputFile = inputFile_in;
+	size_t slash = inputFile.find_last_of("/\\");
+	outDir = (slash == string::npos) ? "" : inputFile.substr(0, slash + 1);
+}
+
+MoorDynSystem::~MoorDynSystem()
+{
+	if (initialized)
+		LinesClose();
+}
+
+
 // master function to handle time stepping (updated in v1.0.1 to follow MoorDyn F)
-void RHSmaster( const double X[],  double Xd[], const double t, double dt)
+void MoorDynSystem::RHSmaster( const double X[],  double Xd[], const double t, double dt)
 {
 	//for (int l=0; l < nConnects; l++)  {	
 	//	ConnectList[l].doRHS((X + 6*l), (Xd + 6*l), t);
 	//}		
 
 	// extrapolate instaneous fairlead positions
+	ProfScope pFairs(Profile ? &prof[PROF_FAIRLEADS] : NULL);
 	for (int l=0; l<nFairs; l++)  
 		ConnectList[FairIs[l]].updateFairlead( t ); 
+	pFairs.stop();
 	
 	
 	// calculate forces on all connection objects	
+	ProfScope pConns(Profile ? &prof[PROF_CONNECTS] : NULL);
 	for (int l=0; l<nConnects; l++)  
 		ConnectList[l].getNetForceAndMass(); 
 
 	// calculate connect dynamics (including contributions from latest line dynamics, above, as well as hydrodynamic forces)
 	for (int l=0; l<nConns; l++)  
 		ConnectList[ConnIs[l]].doRHS((X + 6*l), (Xd + 6*l), t);
+	pConns.stop();
 		
 
 	// calculate line dynamics
+	ProfScope pLines(Profile ? &prof[PROF_LINES] : NULL);
 	for (int l = 0; l < nLines; l++) 
-		LineList[l].doRHS((X + LineStateIs[l]), (Xd + LineStateIs[l]), t, dt);
+	{
+		if (lineSubcycled[l])  // this line is advanced afterwards with its own time step, so hold its states here
+		{
+			for (int i=0; i<6*(LineList[l].getN()-1); i++)  Xd[LineStateIs[l] + i] = 0.0;
+		}
+		else
+			LineList[l].doRHS((X + LineStateIs[l]), (Xd + LineStateIs[l]), t, dt);
+	}
 
 	return;
 }
 
 
 // Runge-Kutta 2 integration routine  (integrates states and time)
-void rk2 (double x0[], double *t0, double dt )
+void MoorDynSystem::rk2 (double x0[], double *t0, double dt )
 {
 	RHSmaster(x0, f0, *t0, 0.5*dt);	 								// get derivatives at t0.      f0 = f ( t0, x0 );
 
@@ -144,7 +135,127 @@ void rk2 (double x0[], double *t0, double dt )
 }
 
 
-double GetOutput(OutChanProps outChan)
+// semi-implicit Euler integration routine (integrates states and time).  Line axial stiffness and internal
+// damping are handled implicitly by each Line, so the step size is no longer bound by the axial wave speed.
+// Connect-type nodes use a symplectic Euler update.
+void MoorDynSystem::sie (double x0[], double *t0, double dt )
+{
+	RHSmaster(x0, f0, *t0, dt);	 								// get derivatives and line forces at t0
+	
+	for (int l=0; l<nConns; l++)  {
+		for (int I=0; I<3; I++)  {
+			x0[6*l + I] += dt*f0[6*l + I];							// connect velocities
+			x0[6*l + 3 + I] += dt*x0[6*l + I];						// connect positions
+		}
+	}
+	
+	for (int l=0; l<nLines; l++)
+		LineList[l].stepSemiImplicit((x0 + LineStateIs[l]), dt);	// line internal nodes
+	
+	*t0 = *t0 + dt;										// update time
+	
+	return;
+}
+
+
+// largest mooring time step to use: dtM0, or the CFL limit over all lines (times CFLfac) if dtMauto is set.
+// The tangent stiffness of viscoE lines changes with load, so this is re-evaluated every coupling step.
+double MoorDynSystem::MaxTimeStep (void)
+{
+	if (Integrator == 1)	// the semi-implicit scheme is not bound by the axial CFL limit
+		return dtM0;
+	
+	if ((dtMauto == 0) && (LocalDt == 0))
+		return dtM0;
+	
+	double dtMax = 1.0e10;
+	for (int l=0; l<nLines; l++)
+	{
+		dtMline[l] = CFLfac*LineList[l].getStableDt();
+		dtMax = min(dtMax, dtMline[l]);
+	}
+	
+	if (dtMauto == 0)
+		return dtM0;
+	
+	return dtMax;
+}
+
+
+// advance the states over one coupling step dtC with per-line sub-cycling.  Lines that need the full NdtM
+// steps are integrated together with the connections; the other lines are then advanced in parallel with
+// their own larger steps, while their end kinematics are interpolated linearly over the coupling step.
+// Only lines between fixed and vessel ends are sub-cycled: a connect-type node is integrated with the end
+// forces of its lines, which a sub-cycled line would only update at the end of the coupling step.
+void MoorDynSystem::LocalTimeStep (double x0[], double *t0, double dtC, int NdtM )
+{
+	double tStart = *t0;
+	double dtM = dtC/NdtM;
+	
+	for (int l=0; l<nLines; l++)
+	{
+		NdtLine[l] = min(NdtM, max(1, (int)ceil(dtC/dtMline[l])));
+		for (int c=0; c<nConns; c++)
+			if ((LineList[l].AnchConnect == &ConnectList[ConnIs[c]]) || (LineList[l].FairConnect == &ConnectList[ConnIs[c]]))
+				NdtLine[l] = NdtM;
+		lineSubcycled[l] = (NdtLine[l] < NdtM);
+	}
+	
+	// connection kinematics at the start of the synchronization interval
+	for (int l=0; l<nFairs; l++)  
+		ConnectList[FairIs[l]].updateFairlead( tStart ); 
+	for (int l=0; l<nConns; l++)  
+		ConnectList[ConnIs[l]].setConnectState( (x0 + 6*l), tStart );
+	for (int l=0; l<nConnects; l++)  
+		ConnectList[l].syncStart( tStart );
+	
+	// connections and fast lines
+	for (int its = 0; its < NdtM; its++) 
+		rk2(x0, t0, dtM);
+	
+	// connection kinematics at the end of the synchronization interval
+	for (int l=0; l<nFairs; l++)  
+		ConnectList[FairIs[l]].updateFairlead( *t0 ); 
+	for (int l=0; l<nConns; l++)  
+		ConnectList[ConnIs[l]].setConnectState( (x0 + 6*l), *t0 );
+	for (int l=0; l<nConnects; l++)  
+		ConnectList[l].syncEnd( *t0 );
+	
+	// sub-cycled lines, each with its own time step
+	#pragma omp parallel for schedule(dynamic)
+	for (int l=0; l<nLines; l++)
+	{
+		if (lineSubcycled[l])
+		{
+			double dtL = dtC/NdtLine[l];
+			for (int its = 0; its < NdtLine[l]; its++)
+				LineList[l].stepRK2((x0 + LineStateIs[l]), tStart + its*dtL, dtL);
+		}
+	}
+	
+	// close the synchronization interval and refresh the fairlead forces with the latest line end forces
+	for (int l=0; l<nConnects; l++)  
+		ConnectList[l].syncStart( *t0 );
+	for (int l=0; l<nLines; l++)
+		lineSubcycled[l] = 0;
+	for (int l=0; l<nFairs; l++)
+		ConnectList[FairIs[l]].getNetForceAndMass();
+	
+	return;
+}
+
+
+// advance the states by one mooring time step using the selected integration scheme
+void MoorDynSystem::TimeStep (double x0[], double *t0, double dt )
+{
+	if (Integrator == 1)
+		sie(x0, t0, dt);
+	else
+		rk2(x0, t0, dt);
+}
+
+
+double MoorDynSystem::GetOutput(OutChanProps outChan)
 {
 	if (outChan.OType == 1)   // line type
 		return LineList[outChan.ObjID-1].GetLineOutput(outChan);
@@ -153,7 +264,7 @@ double GetOutput(OutChanProps outChan)
 }
 
 // write all the output files for the current timestep
-void AllOutput(double t, double dtC)
+void MoorDynSystem::AllOutput(double t, double dtC)
 {
 	// if using a certain output time step, check whether we should output
 	
@@ -164,10 +275,13 @@ void AllOutput(double t, double dtC)
 	// What the above does is say if ((dtOut==0) || (t >= (floor((t-dtC)/dtOut) + 1.0)*dtOut)), do the below.
 	// This way we avoid the risk of division by zero.
 	
-	// write to master output file
-	if (outfileMain.is_open())
+	ProfScope pOut(Profile ? &prof[PROF_OUTPUT] : NULL);
+	
+	// write to master output file (values are snapshot here and written by the output writer thread)
+	if (outWriterMain)
 	{
-		outfileMain << t << "\t "; 		// output time
+		double* row = outWriterMain->beginRow();
+		row[0] = t; 		// output time
 	
 	
 		// output all LINE fairlead (top end) tensions
@@ -177,10 +291,10 @@ void AllOutput(double t, double dtC)
 		for (int lf=0; lf<outChans.size(); lf++)   
 		{
 			//cout << "Getting output: OType:" << outChans[lf].OType << ", ObjID:" << outChans[lf].ObjID << ", QType:" <<outChans[lf].QType << endl;
-			outfileMain << GetOutput(outChans[lf]) << "\t ";		// output each channel's value
+			row[1+lf] = GetOutput(outChans[lf]);		// output each channel's value
 		}
 			
-		outfileMain << "\n";
+		outWriterMain->commitRow();
 	}
 	else cout << "Unable to write to main output file " << endl;
 		
@@ -192,8 +306,174 @@ void AllOutput(double t, double dtC)
 
 
 
+// hash of everything the converged ICs depend on: the input file, the SYNCOM material files and the
+// initial platform position
+uint64_t MoorDynSystem::ICcacheHash(const double X[])
+{
+	vector<string> fnames(1, inputFile);
+	for (int l=0; l<nLines; l++)
+	{
+		string fSC = LineList[l].SC_getInputFile();
+		if ((fSC.size() > 0) && (find(fnames.begin(), fnames.end(), fSC) == fnames.end()))
+			fnames.push_back(fSC);
+	}
+	
+	uint64_t h = hashFNV1a(X, 6*sizeof(double));
+	h = hashFNV1a(&nX, sizeof(nX), h);
+	h = hashFNV1a(&stateVersion, sizeof(stateVersion), h);	// caches of another layout are not found
+	for (int f=0; f<fnames.size(); f++)
+	{
+		ifstream infile(fnames[f].c_str(), ios::in | ios::binary);
+		stringstream contents;
+		contents << infile.rdbuf();
+		string str = contents.str();
+		h = hashFNV1a(fnames[f].c_str(), fnames[f].size(), h);
+		if (str.size() > 0)  h = hashFNV1a(str.c_str(), str.size(), h);
+	}
+	return h;
+}
+
+string MoorDynSystem::ICcacheName(uint64_t ICHash)
+{
+	stringstream fname;
+	fname << outDir << "ICcache_" << hex << ICHash << ".bin";
+	return fname.str();
+}
+
+// load converged ICs from the cache.  The line and connection internals are refreshed from the loaded 
+// states before the SYNCOM histories are restored.  Returns 1 if the ICs were loaded, 0 (with nothing
+// modified) if there is no usable cache.
+int MoorDynSystem::readICcache(uint64_t ICHash, double dtM)
+{
+	string fname = ICcacheName(ICHash);
+	ifstream cachefile(fname.c_str(), ios::in | ios::binary);
+	if (!cachefile.is_open())
+		return 0;
+	
+	char magic[4];
+	uint64_t hashIn, sizeIn;
+	int nXin;
+	cachefile.read(magic, 4);
+	cachefile.read((char*)&hashIn, sizeof(hashIn));
+	cachefile.read((char*)&sizeIn, sizeof(sizeIn));
+	cachefile.read((char*)&nXin, sizeof(nXin));
+	if ((!cachefile) || (strncmp(magic, "MDIC", 4) != 0) || (hashIn != ICHash) || (nXin != nX))
+		return 0;
+	
+	// check that the file is complete before anything is modified
+	streampos pos = cachefile.tellg();
+	cachefile.seekg(0, ios::end);
+	if ((uint64_t)cachefile.tellg() != sizeIn)
+		return 0;
+	cachefile.seekg(pos);
+	
+	vector< double > statesIn(nX);
+	cachefile.read((char*)&statesIn[0], nX*sizeof(double));
+	if (!cachefile)
+		return 0;
+	
+	// read the SYNCOM sections into a buffer and check them against the lines (a mismatch is a cache miss)
+	stringstream linesIn;
+	linesIn << cachefile.rdbuf();
+	for (int l=0; l<nLines; l++)
+	{
+		if (LineList[l].SC_checkState(linesIn) != 0)
+		{
+			cout << "   SYNCOM states in IC cache " << fname << " do not match the lines, regenerating the ICs" << endl;
+			return 0;
+		}
+	}
+	linesIn.clear();
+	linesIn.seekg(0);
+	
+	memcpy(states, &statesIn[0], nX*sizeof(double));
+	RHSmaster(states, f0, 0.0, dtM);
+	
+	for (int l=0; l<nLines; l++)
+		LineList[l].SC_loadState(linesIn);
+	return 1;
+}
+
+void MoorDynSystem::writeICcache(uint64_t ICHash)
+{
+	string fname = ICcacheName(ICHash);
+	ofstream cachefile(fname.c_str(), ios::out | ios::binary);
+	if (!cachefile.is_open())
+	{
+		cout << "   Warning: unable to write IC cache " << fname << endl;
+		return;
+	}
+	
+	uint64_t sizeOut = 0;	// total file size, filled in at the end
+	cachefile.write("MDIC", 4);
+	cachefile.write((char*)&ICHash, sizeof(ICHash));
+	cachefile.write((char*)&sizeOut, sizeof(sizeOut));
+	cachefile.write((char*)&nX, sizeof(nX));
+	cachefile.write((char*)states, nX*sizeof(double));
+	for (int l=0; l<nLines; l++)
+		LineList[l].SC_saveState(cachefile);
+	
+	sizeOut = (uint64_t)cachefile.tellp();
+	cachefile.seekp(4 + sizeof(ICHash));
+	cachefile.write((char*)&sizeOut, sizeof(sizeOut));
+	cachefile.close();
+}
+
+
 // initialization function
-int DECLDIR LinesInit(double X[], double XD[])
+// ------------------------------- coupling trace -------------------------------
+// With the RecordTrace option, every call of LinesCalc, FairleadsCalc, LinesCalcAsync/Wait (and the steps 
+// of LinesCalcTrajectory) is logged to Lines.trace, so that a coupled run can be replayed standalone with 
+// the same inputs (bench/MoorDynReplay.cpp).  The file starts with "MDTR", the version, the number of 
+// fairleads, a hash and the path of the input file and the initial X and XD.  Then follow records of a 
+// type character and doubles:
+//   'L'  LinesCalc:       t, dt, X[6], XD[6]
+//   'F'  FairleadsCalc:   t, dt, fairlead positions [3*nFairs], fairlead velocities [3*nFairs]
+//   'A'  LinesCalcAsync:  t, dt, X[6], XD[6]
+//   'W'  LinesCalcWait:   1 (or 0 if no kinematics were given), X[6], XD[6]
+//   'R'  result of the preceding call: Flines[6] or the fairlead forces [3*nFairs] (only if it succeeded)
+
+void MoorDynSystem::traceOpen(const double X[], const double XD[])
+{
+	string fname = outDir + "Lines.trace";
+	traceFile.open(fname.c_str(), ios::out | ios::binary);
+	if (!traceFile.is_open())
+	{
+		cout << "   Error: unable to open " << fname << " for recording the coupling trace." << endl;
+		return;
+	}
+	
+	ifstream infile(inputFile.c_str(), ios::in | ios::binary);
+	stringstream contents;
+	contents << infile.rdbuf();
+	string str = contents.str();
+	uint64_t h = hashFNV1a(str.c_str(), str.size());
+	
+	int version = 1;
+	int nPath = inputFile.size();
+	traceFile.write("MDTR", 4);
+	traceFile.write((char*)&version, sizeof(version));
+	traceFile.write((char*)&nFairs, sizeof(nFairs));
+	traceFile.write((char*)&h, sizeof(h));
+	traceFile.write((char*)&nPath, sizeof(nPath));
+	traceFile.write(inputFile.c_str(), nPath);
+	traceFile.write((char*)X, 6*sizeof(double));
+	traceFile.write((char*)XD, 6*sizeof(double));
+	traceFile.flush();
+	
+	cout << "   Recording the coupling trace to " << fname << endl;
+}
+
+void MoorDynSystem::traceWrite(char type, const double* data, int n)
+{
+	traceFile.put(type);
+	traceFile.write((const char*)data, n*sizeof(double));
+	if (type == 'R')
+		traceFile.flush();	// (complete up to the last finished call if the host stops)
+}
+
+
+int MoorDynSystem::LinesInit(double X[], double XD[])
 {	
 
 #ifndef LINUX
@@ -271,6 +551,13 @@ int DECLDIR LinesInit(double X[], double XD[])
 	// ---------------------------- MoorDyn title message ----------------------------
 	cout << "\n Running MoorDyn (v1.01.00C, 2016-04-20)\n   Copyright (c) Matt Hall, licensed under GPL v3.\n";
 	
+	if (!initialized)
+	{
+		lock_guard<mutex> lock(nSystemsMutex);
+		nSystems++;
+		initialized = 1;
+	}
+	
 	//dt = *dTime; // store time step from FAST	
 	
 
@@ -284,7 +571,7 @@ int DECLDIR LinesInit(double X[], double XD[])
 	// --------------------------------- read data from file -----------------------------
 	vector<string> lines;
 	string line;
-	ifstream myfile ("Mooring/lines.txt");     // open an input stream to the line data input file
+	ifstream myfile (inputFile.c_str());     // open an input stream to the line data input file
 	if (myfile.is_open())
 	{
 		while ( myfile.good() )
@@ -309,6 +596,8 @@ int DECLDIR LinesInit(double X[], double XD[])
 	env.cb = 3.0e5;
 	env.WaveKin = 0;   // 0=none, 1=from function, 2=from file
 	env.WriteUnits = 1;	// by default, write units line
+	env.WaveCache = 0;	// by default, don't store wave kinematics on disk
+	env.WaveWindow = 0.0;	// by default, precalculate the whole wave kinematics time series
 		
 	double ICDfac = 5; // factor by which to boost drag coefficients during dynamic relaxation IC generation
 	double ICdt = 1.0;						// convergence analysis time step for IC generation
@@ -316,6 +605,20 @@ int DECLDIR LinesInit(double X[], double XD[])
 	double ICthresh = 0.001;					// threshold for relative change in tensions to call it converged
 	
 	dtM0 = 0.001;  // default value for desired mooring model time step
+	Integrator = 0;	// default solver options (reset in case of a previous LinesInit call)
+	SCrate = 1;
+	SCdEps = 0.0;
+	SCskipTol = 0.0;
+	SCskipMax = 10;
+	dtMauto = 0;
+	CFLfac = 0.5;
+	LocalDt = 0;
+	OutFormat = 0;
+	ICgen = 0;
+	ICcache = 0;
+	AsyncTol = 0.01;
+	Profile = 0;
+	RecordTrace = 0;
 
 	// fairlead and anchor position arrays
 	vector< vector< double > > rFairt;
@@ -469,7 +772,7 @@ int DECLDIR LinesInit(double X[], double XD[])
 						// make an output file for it
 						if ((outchannels.size() > 0) && (strcspn( outchannels.c_str(), "pvUDctsd") < strlen(outchannels.c_str())))  // if 1+ output flag chars are given and they're valid
 						{	stringstream oname;
-							oname << "Mooring/Line" << number << ".out";
+							oname << outDir << "Line" << number << ".out";
 							outfiles.push_back( make_shared<ofstream>(oname.str())); // used to trigger a problem
 						}
 						else  outfiles.push_back(NULL);  // null pointer to indicate we're not using an output file here
@@ -493,7 +796,7 @@ int DECLDIR LinesInit(double X[], double XD[])
 						// set up line properties
 						tempLine.setup(number, LinePropList[TypeNum], UnstrLen, NumNodes, 
 							ConnectList[AnchIndex], ConnectList[FairIndex], 
-							outfiles.back(), outchannels);
+							outfiles.back(), outchannels, outDir);
 							
 							
 						LineList.push_back(tempLine); // new  -- resizing the Line contents before adding to LineList (seems to prevent memory bugs)
@@ -536,7 +839,23 @@ int DECLDIR LinesInit(double X[], double XD[])
 						else if ((entries[1] == "threshIC") || (entries[1] == "ICthresh"))  ICthresh = atof(entries[0].c_str()); // "
 						else if (entries[1] == "WaveKin")                                   env.WaveKin = atoi(entries[0].c_str());
 						else if (entries[1] == "WriteUnits")                                env.WriteUnits = atoi(entries[0].c_str());
+						else if (entries[1] == "WaveCache")                                 env.WaveCache = atoi(entries[0].c_str()); // 1 = store/reuse wave kinematics in WaveCache_Line#.bin next to the input file
+						else if (entries[1] == "WaveWindow")                                env.WaveWindow = atof(entries[0].c_str()); // generate wave kinematics lazily in windows of this length (s)
+						else if (entries[1] == "OutFormat")                                 OutFormat = atoi(entries[0].c_str()); // 0 = text output, 1 = binary output
+						else if (entries[1] == "ICgen")                                     ICgen = atoi(entries[0].c_str()); // 0 = dynamic relaxation, 1 = kinetic damping
+						else if (entries[1] == "ICcache")                                   ICcache = atoi(entries[0].c_str()); // 1 = store/reuse converged ICs
+						else if (entries[1] == "AsyncTol")                                  AsyncTol = atof(entries[0].c_str()); // fairlead deviation (m) that makes LinesCalcWait redo a step
+						else if (entries[1] == "Profile")                                   Profile = atoi(entries[0].c_str()); // 1 = time the solver phases (see GetProfile)
+						else if (entries[1] == "RecordTrace")                               RecordTrace = atoi(entries[0].c_str()); // 1 = log the coupling calls to Lines.trace
 						else if (entries[1] == "dtOut")                                     dtOut = atof(entries[0].c_str()); // output writing period (0 for at every call)
+						else if (entries[1] == "Integrator")                                Integrator = atoi(entries[0].c_str()); // 0 = RK2, 1 = semi-implicit Euler
+						else if (entries[1] == "SCrate")                                    SCrate = atoi(entries[0].c_str()); // SYNCOM update interval in RHS calls
+						else if (entries[1] == "SCdEps")                                    SCdEps = atof(entries[0].c_str()); // strain increment forcing a SYNCOM update
+						else if (entries[1] == "SCskipTol")                                 SCskipTol = atof(entries[0].c_str()); // strain tolerance for reusing SYNCOM evaluations
+						else if (entries[1] == "SCskipMax")                                 SCskipMax = atoi(entries[0].c_str()); // max consecutive reuses of a SYNCOM evaluation
+						else if (entries[1] == "dtMauto")                                   dtMauto = atoi(entries[0].c_str()); // 1 = pick dtM from the CFL limit
+						else if (entries[1] == "CFLfac")                                    CFLfac = atof(entries[0].c_str()); // safety factor on the CFL limit
+						else if (entries[1] == "LocalDt")                                   LocalDt = atoi(entries[0].c_str()); // 1 = per-line sub-cycling
 					}
 					i++;
 				}
@@ -944,10 +1263,22 @@ int DECLDIR LinesInit(double X[], double XD[])
 	
 	// ------------------ do dynamic relaxation IC gen --------------------
 	
-	cout << "   Finalizing ICs using dynamic relaxation (" << ICDfac << "X normal drag)" << endl;
+	if (ICgen == 1)
+	{
+		ICDfac = 1.0;	// kinetic damping removes the energy itself, so no extra drag is needed
+		cout << "   Finalizing ICs using kinetic damping" << endl;
+	}
+	else
+		cout << "   Finalizing ICs using dynamic relaxation (" << ICDfac << "X normal drag)" << endl;
+	if (Integrator == 1) cout << "   Using semi-implicit time integration" << endl;
+	if ((SCrate > 1) || (SCdEps > 0.0)) cout << "   Using multi-rate SYNCOM updates (SCrate = " << SCrate << ", SCdEps = " << SCdEps << ")" << endl;
+	if (SCskipTol > 0.0) cout << "   Reusing SYNCOM evaluations of quiescent segments (SCskipTol = " << SCskipTol << ", SCskipMax = " << SCskipMax << ")" << endl;
 	
 	for (int l=0; l < nLines; l++) LineList[l].scaleDrag(ICDfac); // boost drag coefficient
 	
+	for (int k=0; k<PROF_NSYS; k++)  prof[k].reset();
+	for (int l=0; l < nLines; l++) LineList[l].setProfile(Profile);
+	
 	int niic = round(ICTmax/ICdt);			// max number of IC gen time steps
 	
 	double Ffair[3];						// array to temporarily store fairlead force components
@@ -959,17 +1290,58 @@ int DECLDIR LinesInit(double X[], double XD[])
 	
 	
 	// round to get appropriate mooring model time step
-	int NdtM = ceil(ICdt/dtM0);   // number of mooring model time steps per outer time step
+	dtMline.assign(nLines, dtM0);
+	NdtLine.assign(nLines, 1);
+	lineSubcycled.assign(nLines, 0);
+	double dtMmax = MaxTimeStep();
+	if (dtMauto && (Integrator != 1)) cout << "   Using CFL-limited time step dtM = " << dtMmax << " s" << endl;
+	if (LocalDt && (Integrator != 1)) cout << "   Using per-line sub-cycling" << endl;
+	int NdtM = ceil(ICdt/dtMmax);   // number of mooring model time steps per outer time step
 	double dtM = ICdt/NdtM;		// mooring model time step size (s)
 	
+	double KElast = 0.0;		// kinetic energy after the previous step (for kinetic damping)
+	
+	// reuse the converged ICs of an identical earlier run if they are in the cache
+	uint64_t ICHash = 0;
+	int ICloaded = 0;
+	if (ICcache > 0)
+	{
+		ICHash = ICcacheHash(X);
+		ICloaded = readICcache(ICHash, dtM);
+		if (ICloaded)
+		{
+			cout << "   Loaded converged ICs from " << ICcacheName(ICHash) << endl;
+			niic = 0;	// skip the IC generation
+		}
+	}
+	
 	// loop through IC generation time analysis time steps
+	ProfScope pIC(Profile ? &prof[PROF_ICGEN] : NULL);
 	for (int iic=0; iic<niic; iic++)
 	{
 		double t = iic*ICdt;			// IC gen time (s).  << is this a robust way to handle time progression?
 		
 		// loop through line integration time steps
 		for (int its = 0; its < NdtM; its++)
-			rk2 (states, &t, dtM );  			// call RK2 time integrator (which calls the model)
+		{
+			TimeStep(states, &t, dtM);  			// call time integrator (which calls the model)
+			
+			if (ICgen == 1)
+			{
+				// kinetic damping: once the kinetic energy of the system passes a peak, stop all nodes
+				double KE = 0.0;
+				for (int l=0; l<nLines; l++)  KE += LineList[l].getKineticEnergy(states + LineStateIs[l]);
+				
+				if (KE < KElast)
+				{
+					for (int l=0; l<nLines; l++)  LineList[l].zeroVelocities(states + LineStateIs[l]);
+					for (int l=0; l<nConns; l++)  
+						for (int J=0; J<3; J++)  states[6*l + J] = 0.0;		// connect velocities
+					KE = 0.0;
+				}
+				KElast = KE;
+			}
+		}
 	
 		// check for NaNs
 		for (int i=0; i<nX; i++)
@@ -1017,6 +1389,7 @@ int DECLDIR LinesInit(double X[], double XD[])
 			}
 		}
 	}
+	pIC.stop();
 	
 	for (int l=0; l < nLines; l++) 
 	{
@@ -1025,21 +1398,28 @@ int DECLDIR LinesInit(double X[], double XD[])
 
 		//---------------SYNCOM Modification------------------------//
 		LineList[l].SC_offInit();
-		LineList[l].SC_updateParams(dtM);
+		if (!ICloaded) LineList[l].SC_updateParams(dtM);	// (cached histories are already final)
+		LineList[l].SC_setMultiRate(SCrate, SCdEps);
+		LineList[l].SC_setSkip(SCskipTol, SCskipMax);
 		//---------------End of Modification------------------------//
 	}
 	
+	if ((ICcache > 0) && !ICloaded)
+		writeICcache(ICHash);
+	
 
 	// ------------------------- calculate wave time series if needed -------------------
 	if (env.WaveKin == 2)
 	{
+		// lines in parallel (the node loop inside each line then runs in the line's thread)
+		#pragma omp parallel for schedule(dynamic)
 		for (int l=0; l<nLines; l++) 
 			LineList[l].makeWaveKinematics( 0.0 );
 	}
 
 	
 	// -------------------------- start main output file --------------------------------
-	outfileMain.open("Mooring/Lines.out");
+	outfileMain.open((outDir + "Lines.out").c_str());
 	if (outfileMain.is_open())
 	{
 		// --- channel titles ---
@@ -1059,9 +1439,36 @@ int DECLDIR LinesInit(double X[], double XD[])
 	}
 	else cout << "   ERROR: Unable to write to main output file " << endl;  //TODO: handle error
 	
+	// start the buffered output writers (the header lines above and in Line::initialize are already written)
+	outWriterMain.reset();
+	if (outfileMain.is_open())
+	{
+		outWriterMain = make_shared<OutputWriter>();
+		if (outWriterMain->setup(&outfileMain, outDir + "Lines.bin", 1 + outChans.size(), OutFormat) != 0)
+			outWriterMain.reset();
+	}
+	outWriters.assign(nLines, shared_ptr<OutputWriter>());
+	for (int l=0; l<nLines; l++)
+	{
+		if (outfiles[l])
+		{
+			stringstream bname;
+			bname << outDir << "Line" << LineList[l].number << ".bin";
+			outWriters[l] = make_shared<OutputWriter>();
+			if (outWriters[l]->setup(outfiles[l].get(), bname.str(), LineList[l].getOutputSize(), OutFormat) != 0)
+				outWriters[l].reset();
+		}
+		LineList[l].setOutputWriter(outWriters[l].get());
+	}
+	
+	tMD = 0.0;
+	
 	// write t=0 output line
 	AllOutput(0.0, 0.0);
 	
+	if (RecordTrace)
+		traceOpen(X, XD);
+	
 	return 0;
 }
 
@@ -1078,7 +1485,7 @@ int DECLDIR SetupWaves(int* WaveMod, int* WaveStMod,
 
 
 // load time series of wave elevations and process to calculate wave kinematics time series for each node
-int SetupWavesFromFile(void)
+int MoorDynSystem::SetupWavesFromFile(void)
 {
 	// much of this process is taken from GenerateWaveExctnFile.py
 
@@ -1087,7 +1494,7 @@ int SetupWavesFromFile(void)
 	// --------------------- read data from file ------------------------
 	vector<string> lines2;
 	string line2;
-	string WaveFilename = "waves.txt";  // should set as overideable default later
+	string WaveFilename = inputPath(outDir, "waves.txt");  // should set as overideable default later
 	
 	ifstream myfile2 (WaveFilename);     // open an input stream to the wave elevation time series file
 	if (myfile2.is_open())
@@ -1190,7 +1597,7 @@ int SetupWavesFromFile(void)
 	if (wordy > 2) cout << "starting fft stuff " << endl;
 		int NFFT = NtW;
 		int is_inverse_fft = 0;
-	kiss_fft_cfg cfg = kiss_fft_alloc( NFFT , is_inverse_fft ,0,0 );
+	kiss_fft_cfg cfg = getFFTplan( NFFT , is_inverse_fft );	// shared plan (freed in LinesClose)
 	
 	// making data structures
 	//typedef struct {
@@ -1234,7 +1641,6 @@ int SetupWavesFromFile(void)
 	// free things up  (getting errors here! suggests heap corruption elsewhere?)
 	free(cx_in);
 	free(cx_out);
-	free(cfg);
 
 	if (wordy > 2) cout << "freed" << endl;
 /*     Note: frequency-domain data is stored from dc up to 2pi.
@@ -1281,7 +1687,7 @@ int SetupWavesFromFile(void)
 
 
 // This is the original time stepping function, for platform-centric coupling.
-int DECLDIR LinesCalc(double X[], double XD[], double Flines[], double* t_in, double* dt_in) 
+int MoorDynSystem::LinesCalc(double X[], double XD[], double Flines[], double* t_in, double* dt_in) 
 {
 	     // From FAST: The primary output of this routine is array Flines(:), which must
          // contain the 3 components of the total force from all mooring lines
@@ -1304,6 +1710,16 @@ int DECLDIR LinesCalc(double X[], double XD[], double Flines[], double* t_in, do
 	double t =  *t_in;		// this is the current time
 	double dtC =  *dt_in;	// this is the coupling time step
 
+	if (traceOn())
+	{
+		double rec[14] = {t, dtC};
+		for (int J=0; J<6; J++)  {
+			rec[2+J] = X[J];
+			rec[8+J] = XD[J];
+		}
+		traceWrite('L', rec, 14);
+	}
+	
 	// should check if wave kinematics have been set up if expected!
 	
 	
@@ -1337,7 +1753,9 @@ int DECLDIR LinesCalc(double X[], double XD[], double Flines[], double* t_in, do
 		
 		
 		// call new fairlead-centric time stepping function (replaced part of what used to be in this function)
+		traceSuspend++;
 		FairleadsCalc(rFairi, rdFairi, Ffair, t_in, dt_in);
+		traceSuspend--;
 		
 		
 	//	// send latest fairlead kinematics to fairlead objects
@@ -1394,36 +1812,263 @@ int DECLDIR LinesCalc(double X[], double XD[], double Flines[], double* t_in, do
 	
 	for (int ii=0; ii<6; ii++) Flines[ii] = FlinesS[ii];  // assign static Flines vector to returned Flines vector (for FAST)
 	
+	if (traceOn())
+		traceWrite('R', Flines, 6);
+	
 	return 0;
 }
 
 
+// advance the model through a prescribed platform motion history in one call.  X and XD hold the 
+// platform position and velocity (6 values each) at the start time t[i] of each of the n steps.  The step 
+// size is t[i+1]-t[i] (the last step repeats the previous size).  After each step, the 6 platform loads,
+// the top end tension and the SYNCOM fairlead strain of every line are stored in row i of the output 
+// arrays (n x 6, n x nLines, n x nLines); any output array may be NULL.
+int MoorDynSystem::LinesCalcTrajectory(const double* X, const double* XD, const double* t, size_t n, 
+	double* Flines_out, double* fairTen_out, double* epsFL_out)
+{
+	if ((n < 2) || (X == NULL) || (XD == NULL) || (t == NULL))
+	{
+		cout << "   Error: LinesCalcTrajectory needs the motion at two or more times." << endl;
+		return -1;
+	}
+	for (size_t i=0; i<n-1; i++)
+	{
+		if (t[i+1] <= t[i])
+		{
+			cout << "   Error: LinesCalcTrajectory needs increasing times (t[" << i+1 << "] = " << t[i+1] << " s)." << endl;
+			return -1;
+		}
+	}
+	
+	double Xi[6], XDi[6], Flines[6];
+	for (size_t i=0; i<n; i++)
+	{
+		double ti = t[i];
+		double dtC = (i < n-1) ? t[i+1] - t[i] : t[i] - t[i-1];
+		
+		for (int J=0; J<6; J++)  {		// (LinesCalc takes non-const arrays)
+			Xi[J] = X[6*i + J];
+			XDi[J] = XD[6*i + J];
+		}
+		
+		if (LinesCalc(Xi, XDi, Flines, &ti, &dtC) != 0)
+		{
+			cout << "   Error: LinesCalcTrajectory stopped at step " << i << " (t = " << t[i] << " s)." << endl;
+			return -1;
+		}
+		
+		if (Flines_out)
+			for (int J=0; J<6; J++)  Flines_out[6*i + J] = Flines[J];
+		
+		for (int l=0; l<nLines; l++)
+		{
+			if (fairTen_out)
+				fairTen_out[nLines*i + l] = GetFairTen(l+1);
+			if (epsFL_out)
+			{
+				epsFL_out[nLines*i + l] = 0.0;		// (left at zero for lines without SYNCOM)
+				SC_GetEpsFL(l+1, &epsFL_out[nLines*i + l]);
+			}
+		}
+	}
+	return 0;
+}
+
+
+// ------------------------------- asynchronous coupling -------------------------------
+// LinesCalcAsync starts a coupling step on a worker thread with predicted (e.g. extrapolated) platform 
+// kinematics, so that the host can advance its own solution meanwhile.  LinesCalcWait then takes the 
+// actual kinematics.  If any fairlead position at the start or end of the step deviates from the predicted 
+// one by more than AsyncTol, the step is redone from a snapshot with the actual kinematics.  Outputs are 
+// written only once a step has been accepted.
+
+// fairlead positions at the start and at the end of a coupling step (6 values per fairlead)
+void MoorDynSystem::fairleadPath(const double X[], const double XD[], double dtC, vector<double>& rOut)
+{
+	double TransMat[9];
+	RotMat(X[3], X[4], X[5], TransMat);
+	
+	rOut.resize(6*nFairs);
+	for (int ln=0; ln < nFairs; ln++)
+	{
+		double rRel[3], rd[3];
+		for (int J=0; J<3; J++)
+			rRel[J] = TransMat[3*J]*rFairtS[ln][0] + TransMat[3*J+1]*rFairtS[ln][1] + TransMat[3*J+2]*rFairtS[ln][2];
+		
+		rd[0] =                  - XD[5]*rRel[1] + XD[4]*rRel[2] + XD[0];
+		rd[1] =  XD[5]*rRel[0]                   - XD[3]*rRel[2] + XD[1];
+		rd[2] = -XD[4]*rRel[0] + XD[3]*rRel[1]                   + XD[2];
+		
+		for (int J=0; J<3; J++)
+		{
+			rOut[6*ln + J] = rRel[J] + X[J];
+			rOut[6*ln + 3 + J] = rOut[6*ln + J] + rd[J]*dtC;
+		}
+	}
+}
+
+void MoorDynSystem::asyncStep(void)
+{
+	traceSuspend++;
+	asyncErr = LinesCalc(asyncX, asyncXD, asyncF, &asyncT, &asyncDt);
+	traceSuspend--;
+}
+
+int MoorDynSystem::LinesCalcAsync(double X[], double XD[], double* t_in, double* dt_in)
+{
+	if (asyncBusy)
+	{
+		cout << "   Error: LinesCalcAsync called again before LinesCalcWait." << endl;
+		return -1;
+	}
+	
+	for (int J=0; J<6; J++)  {
+		asyncX[J] = X[J];
+		asyncXD[J] = XD[J];
+	}
+	asyncT = *t_in;
+	asyncDt = *dt_in;
+	
+	if (traceOn())
+	{
+		double rec[14] = {asyncT, asyncDt};
+		for (int J=0; J<6; J++)  {
+			rec[2+J] = X[J];
+			rec[8+J] = XD[J];
+		}
+		traceWrite('A', rec, 14);
+	}
+	
+	// snapshot of the current state, to redo the step if the prediction turns out to be off
+	asyncSnapshot.str("");
+	asyncSnapshot.clear();
+	saveState(asyncSnapshot);
+	
+	skipOutput = 1;
+	asyncBusy = 1;
+	asyncSteps++;
+	asyncThread = thread(&MoorDynSystem::asyncStep, this);
+	return 0;
+}
+
+int MoorDynSystem::LinesCalcWait(double X[], double XD[], double Flines[])
+{
+	if (!asyncBusy)
+	{
+		cout << "   Error: LinesCalcWait called without a pending LinesCalcAsync step." << endl;
+		return -1;
+	}
+	
+	asyncThread.join();
+	asyncBusy = 0;
+	skipOutput = 0;
+	
+	if (traceOn())
+	{
+		double rec[13] = {(X != NULL) && (XD != NULL) ? 1.0 : 0.0};
+		if (rec[0] > 0.0)
+			for (int J=0; J<6; J++)  {
+				rec[1+J] = X[J];
+				rec[7+J] = XD[J];
+			}
+		traceWrite('W', rec, 13);
+	}
+	
+	int err = asyncErr;
+	int redo = 0;
+	
+	// compare the predicted fairlead path with the actual one (no check if no actual kinematics are given)
+	if ((err == 0) && (X != NULL) && (XD != NULL))
+	{
+		vector<double> rPred, rAct;
+		fairleadPath(asyncX, asyncXD, asyncDt, rPred);
+		fairleadPath(X, XD, asyncDt, rAct);
+		
+		for (int i=0; i<2*nFairs; i++)
+		{
+			double dr = sqrt(  (rAct[3*i  ]-rPred[3*i  ])*(rAct[3*i  ]-rPred[3*i  ]) 
+			                 + (rAct[3*i+1]-rPred[3*i+1])*(rAct[3*i+1]-rPred[3*i+1])
+			                 + (rAct[3*i+2]-rPred[3*i+2])*(rAct[3*i+2]-rPred[3*i+2]) );
+			if (dr > AsyncTol)
+				redo = 1;
+		}
+	}
+	
+	if (redo)
+	{
+		asyncSnapshot.seekg(0);
+		if (loadState(asyncSnapshot) != 0)
+		{
+			cout << "   Error: unable to restore the state for redoing an asynchronous step." << endl;
+			return -1;
+		}
+		asyncRedone++;
+		traceSuspend++;
+		err = LinesCalc(X, XD, asyncF, &asyncT, &asyncDt);	// (writes the outputs itself)
+		traceSuspend--;
+	}
+	else if (err == 0)
+		AllOutput(tMD, asyncDt);
+	
+	for (int ii=0; ii<6; ii++)  Flines[ii] = asyncF[ii];
+	
+	if ((err == 0) && traceOn())
+		traceWrite('R', Flines, 6);
+	
+	return err;
+}
+
+
 // This function now handles the assignment of fairlead boundary conditions, time stepping, and collection of resulting forces at fairleads
 // It is called by the old LinesCalc function.  It can also be called externally for fairlead-centric coupling.
-int DECLDIR FairleadsCalc(double **rFairIn, double **rdFairIn, double ** fFairIn, double* t_in, double *dt_in)
+int MoorDynSystem::FairleadsCalc(double **rFairIn, double **rdFairIn, double ** fFairIn, double* t_in, double *dt_in)
 {
 	double t =  *t_in;		// this is the current time
 	double dtC =  *dt_in;	// this is the coupling time step
 	
+	int tracing = traceOn();
+	if (tracing)
+	{
+		vector<double> rec(2 + 6*nFairs);
+		rec[0] = t;
+		rec[1] = dtC;
+		for (int l=0; l < nFairs; l++)  
+			for (int J=0; J<3; J++)  {
+				rec[2 + 3*l + J] = rFairIn[l][J];
+				rec[2 + 3*nFairs + 3*l + J] = rdFairIn[l][J];
+			}
+		traceWrite('F', &rec[0], rec.size());
+	}
 	
 	if (dtC > 0) // if DT > 0, do simulation, otherwise leave passed fFairs unadjusted.
 	{
+		ProfScope pStep(Profile ? &prof[PROF_COUPLING] : NULL);
+		
 		// send latest fairlead kinematics to fairlead objects
 		for (int l=0; l < nFairs; l++)  
 			ConnectList[FairIs[l]].initiateStep(rFairIn[l], rdFairIn[l], t);					
 					
 					
 		// round to get appropriate mooring model time step
-		int NdtM = ceil(dtC/dtM0);   // number of mooring model time steps per outer time step
+		double dtMmax = MaxTimeStep();
+		int NdtM = ceil(dtC/dtMmax);   // number of mooring model time steps per outer time step
 		if (NdtM < 1)  
-		{	cout << "   Error: dtC is less than dtM.  (" << dtC << " < " << dtM0 << ")" << endl;
+		{	cout << "   Error: dtC is less than dtM.  (" << dtC << " < " << dtMmax << ")" << endl;
 			return -1;
 		}
 		double dtM = dtC/NdtM;		// mooring model time step size (s)
 
 		// loop through line integration time steps (integrate solution forward by dtC)
-		for (int its = 0; its < NdtM; its++) 
-			rk2(states, &t, dtM);  			// call RK2 time integrator (which calls the model)
+		ProfScope pInt(Profile ? &prof[PROF_TIMESTEP] : NULL);
+		if (LocalDt && (Integrator != 1))
+			LocalTimeStep(states, &t, dtC, NdtM);		// per-line sub-cycling
+		else
+		{
+			for (int its = 0; its < NdtM; its++) 
+				TimeStep(states, &t, dtM);  			// call time integrator (which calls the model)
+		}
+		pInt.stop();
 		
 		// check for NaNs
 		for (int i=0; i<nX; i++)
@@ -1434,28 +2079,63 @@ int DECLDIR FairleadsCalc(double **rFairIn, double **rdFairIn, double ** fFairIn
 				return -1;
 			}
 		}
+		tMD = t;
 				
 		// go through connections to get fairlead forces		
 		for (int l=0; l < nFairs; l++)
 			ConnectList[FairIs[l]].getFnet(fFairIn[l]);
 
-		AllOutput(t, dtC);   // write outputs
+		if (!skipOutput)
+			AllOutput(t, dtC);   // write outputs
+	}
+	
+	if (tracing)
+	{
+		vector<double> rec(3*nFairs);
+		for (int l=0; l < nFairs; l++)  
+			for (int J=0; J<3; J++)  rec[3*l + J] = fFairIn[l][J];
+		traceWrite('R', rec.data(), rec.size());
 	}
 	
 	return 0;
 }
 
 
-int DECLDIR LinesClose(void)
+int MoorDynSystem::LinesClose(void)
 {
+	if (asyncBusy)		// finish a pending asynchronous step
+	{
+		asyncThread.join();
+		asyncBusy = 0;
+	}
+	if (asyncSteps > 0)
+		cout << "   " << asyncRedone << " of " << asyncSteps << " asynchronous steps were redone." << endl;
+	asyncSteps = 0;
+	asyncRedone = 0;
+	
+	if (Profile)
+		printProfile();
+	
+	if (traceFile.is_open())
+		traceFile.close();
+	
 	free(states);
 	free(f0       );
 	free(f1       );
 	free(xt       );	
+	states = f0 = f1 = xt = NULL;
+	
+	if (Ffair)    free2Darray(Ffair, nFairs);
+	if (rFairi)   free2Darray(rFairi, nFairs);
+	if (rdFairi)  free2Darray(rdFairi, nFairs);
+	Ffair = rFairi = rdFairi = NULL;
 	
-	free2Darray(Ffair, nFairs);
-	free2Darray(rFairi, nFairs);
-	free2Darray(rdFairi, nFairs);
+	// finish writing any buffered output
+	if (outWriterMain)
+		outWriterMain->close();
+	for (int l=0; l<outWriters.size(); l++) 
+		if (outWriters[l])
+			outWriters[l]->close();
 	
 	// close any open output files
 	if (outfileMain.is_open())
@@ -1486,18 +2166,35 @@ int DECLDIR LinesClose(void)
 	LinePropList.clear(); 	
 	LineList.clear(); 		
 	ConnectList.clear();	
-	FairIs.clear();  		
+	FairIs.clear();
+	dtMline.clear();
+	NdtLine.clear();
+	lineSubcycled.clear();  		
 	ConnIs.clear();  		
+	outWriterMain.reset();
+	outWriters.clear();
 	outfiles.clear(); 		
 	outChans.clear();		
 	LineStateIs.clear();
 	zetaCglobal.clear();
 	
 	cout << "   MoorDyn closed." << endl;
+	
+	// resources shared by all systems are released with the last one
+	int lastSystem = 0;
+	if (initialized)
+	{
+		lock_guard<mutex> lock(nSystemsMutex);
+		nSystems--;
+		lastSystem = (nSystems == 0);
+		initialized = 0;
+	}
+	if (lastSystem)
+		freeFFTplans();
 
 #ifndef OSX	
 #ifndef LINUX	
-	if (OwnConsoleWindow == 1)  {
+	if ((OwnConsoleWindow == 1) && lastSystem)  {
 		cout << "press enter to close: " << endl;
 		cin.get();
 		FreeConsole();  //_close(hConHandle); // close console window if we made our own.
@@ -1509,7 +2206,7 @@ int DECLDIR LinesClose(void)
 }
 
 
-double DECLDIR GetFairTen(int l)
+double MoorDynSystem::GetFairTen(int l)
 {
 	// output LINE fairlead (top end) tensions
 	if ((l > 0) && (l <= nLines))
@@ -1520,7 +2217,7 @@ double DECLDIR GetFairTen(int l)
 
 
 
-int DECLDIR GetFASTtens(int* numLines, float FairHTen[], float FairVTen[], float AnchHTen[], float AnchVTen[] )
+int MoorDynSystem::GetFASTtens(int* numLines, float FairHTen[], float FairVTen[], float AnchHTen[], float AnchVTen[] )
 {
 	// function for providing FASTv7 customary line tension quantities.  Each array is expected as length nLines
 	
@@ -1530,7 +2227,7 @@ int DECLDIR GetFASTtens(int* numLines, float FairHTen[], float FairVTen[], float
 	return 0;
 }
 
-int DECLDIR GetConnectPos(int l, double pos[3])
+int MoorDynSystem::GetConnectPos(int l, double pos[3])
 {
 	if ((l > 0) && (l <= nConnects))
 	{
@@ -1545,7 +2242,7 @@ int DECLDIR GetConnectPos(int l, double pos[3])
 		return -1;
 }
 
-int DECLDIR GetConnectForce(int l, double force[3])
+int MoorDynSystem::GetConnectForce(int l, double force[3])
 {
 	if ((l > 0) && (l <= nConnects))
 	{
@@ -1557,7 +2254,7 @@ int DECLDIR GetConnectForce(int l, double force[3])
 }
 
 
-int DECLDIR GetNodePos(int LineNum, int NodeNum, double pos[3])
+int MoorDynSystem::GetNodePos(int LineNum, int NodeNum, double pos[3])
 {
 		// output LINE fairlead (top end) tensions
 	if ((LineNum > 0) && (LineNum <= nLines))
@@ -1569,7 +2266,7 @@ int DECLDIR GetNodePos(int LineNum, int NodeNum, double pos[3])
 	return -1;		// otherwise indicate error (invalid node and line number comination)
 }
 
-int DECLDIR GetNodePos_v2(int LineNum, int NodeNum, double pos[3])
+int MoorDynSystem::GetNodePos_v2(int LineNum, int NodeNum, double pos[3])
 {
 	// output LINE fairlead (top end) tensions
 	if ((LineNum > 0) && (LineNum <= nLines)) {
@@ -1580,7 +2277,7 @@ int DECLDIR GetNodePos_v2(int LineNum, int NodeNum, double pos[3])
 	return -1;		// otherwise indicate error (invalid node and line number comination)
 }
 
-int DECLDIR DrawWithGL()
+int MoorDynSystem::DrawWithGL(void)
 {
 #ifdef USEGL
 	// draw the mooring system with OpenGL commands (assuming a GL context has been created by the calling program)
@@ -1591,9 +2288,204 @@ int DECLDIR DrawWithGL()
 	return 0;
 }
 
+// number of segments of a line (LineNum = 1..nLines), or the total over all lines (LineNum = 0)
+int MoorDynSystem::GetLineN(int LineNum)
+{
+	if (LineNum == 0)
+	{
+		int Ntot = 0;
+		for (int l=0; l<nLines; l++)  Ntot += LineList[l].getN();
+		return Ntot;
+	}
+	if ((LineNum > 0) && (LineNum <= nLines))
+		return LineList[LineNum-1].getN();
+	return -1;
+}
+
+// fill out[] with one quantity (MD_NODE_POS etc., see MoorDyn.h) for all nodes/segments of a line, or of
+// all lines one after the other (LineNum = 0).  Returns the number of values written, or -1.
+int MoorDynSystem::GetLineData(int LineNum, int field, double out[])
+{
+	int l0 = LineNum - 1;
+	int l1 = LineNum;
+	if (LineNum == 0)
+	{
+		l0 = 0;
+		l1 = nLines;
+	}
+	else if ((LineNum < 0) || (LineNum > nLines))
+		return -1;
+	
+	int n = 0;
+	for (int l=l0; l<l1; l++)
+	{
+		int N = LineList[l].getN();
+		switch (field)
+		{
+			case MD_NODE_POS:        LineList[l].getNodePositions(out + n);     n += 3*(N+1);  break;
+			case MD_NODE_VEL:        LineList[l].getNodeVelocities(out + n);    n += 3*(N+1);  break;
+			case MD_SEG_TEN:         LineList[l].getSegTensions(out + n);       n += N;        break;
+			case MD_SEG_STRAIN:      LineList[l].getSegStrains(out + n);        n += N;        break;
+			case MD_SC_STRESS:       LineList[l].SC_getSegStress(out + n);      n += N;        break;
+			case MD_SC_EPS_VP:       LineList[l].SC_getSegEpsVP(out + n);       n += N;        break;
+			case MD_SC_SIGMA_YIELD:  LineList[l].SC_getSegSigmaYield(out + n);  n += N;        break;
+			default:
+				return -1;
+		}
+	}
+	return n;
+}
+
+// read-only view of the global state vector, which stays at the same address from LinesInit to 
+// LinesClose.  Each line's internal nodes occupy 6*(N-1) values starting at GetLineStateIndex: first 
+// the velocities, then the positions (x/y/z per node).  Connect-type connections come first (6 each).
+const double* MoorDynSystem::GetStateArray(int* nStates)
+{
+	if (nStates)  *nStates = nX;
+	return states;
+}
+
+int MoorDynSystem::GetLineStateIndex(int LineNum)
+{
+	if ((LineNum > 0) && (LineNum <= nLines))
+		return LineStateIs[LineNum-1];
+	return -1;
+}
+
+// write the complete model state (line/connection states, fairlead kinematics and SYNCOM histories)
+// to a binary stream, so that the simulation can be continued from this point later with loadState
+void MoorDynSystem::saveState(ostream& out)
+{
+	int version = stateVersion;
+	out.write("MDCK", 4);
+	out.write((char*)&version, sizeof(version));
+	out.write((char*)&nX, sizeof(nX));
+	out.write((char*)&nLines, sizeof(nLines));
+	out.write((char*)&nConnects, sizeof(nConnects));
+	
+	out.write((char*)&tMD, sizeof(tMD));
+	out.write((char*)&FlinesS[0], 6*sizeof(double));
+	out.write((char*)states, nX*sizeof(double));
+	for (int l=0; l<nConnects; l++)
+		ConnectList[l].saveState(out);
+	for (int l=0; l<nLines; l++)
+		LineList[l].saveState(out);
+}
+
+// restore a state written by saveState.  The wave kinematics are looked up from the restored time, so 
+// they continue seamlessly.  Returns 0 on success, 1 if the stream is not a supported state, 2 if it is
+// from a different mooring system, 3 if it is incomplete.  Nothing is modified unless 0 is returned.
+int MoorDynSystem::loadState(istream& in)
+{
+	char magic[4];
+	int version, nXin, nLinesIn, nConnectsIn;
+	in.read(magic, 4);
+	in.read((char*)&version, sizeof(version));
+	in.read((char*)&nXin, sizeof(nXin));
+	in.read((char*)&nLinesIn, sizeof(nLinesIn));
+	in.read((char*)&nConnectsIn, sizeof(nConnectsIn));
+	if ((!in) || (strncmp(magic, "MDCK", 4) != 0) || (version != stateVersion))
+		return 1;
+	if ((nXin != nX) || (nLinesIn != nLines) || (nConnectsIn != nConnects))
+		return 2;
+	
+	// check that the stream holds the complete state before anything is modified
+	streamoff sizeConnects = 0, sizeLines = 0;
+	for (int l=0; l<nConnects; l++)
+		sizeConnects += ConnectList[l].getStateSize();
+	for (int l=0; l<nLines; l++)
+		sizeLines += LineList[l].getStateSize();
+	streampos pos = in.tellg();
+	in.seekg(0, ios::end);
+	streamoff sizeLeft = in.tellg() - pos;
+	in.seekg(pos);
+	if ((!in) || (sizeLeft < (streamoff)((7 + nX)*sizeof(double)) + sizeConnects + sizeLines))
+		return 3;
+	
+	double tIn;
+	double FlinesIn[6];
+	vector< double > statesIn(nX);
+	in.read((char*)&tIn, sizeof(tIn));
+	in.read((char*)FlinesIn, 6*sizeof(double));
+	in.read((char*)&statesIn[0], nX*sizeof(double));
+	streampos posConnects = in.tellg();
+	
+	// read the line sections into a buffer and check them against the lines
+	string linesBuf(sizeLines, '\0');
+	in.seekg(posConnects + sizeConnects);
+	in.read(&linesBuf[0], sizeLines);
+	if (!in)
+		return 3;
+	istringstream linesIn(linesBuf);
+	for (int l=0; l<nLines; l++)
+		if (LineList[l].checkState(linesIn) != 0)
+			return 3;
+	linesIn.seekg(0);
+	
+	// everything is in place, so restore the state
+	in.seekg(posConnects);
+	for (int l=0; l<nConnects; l++)
+		ConnectList[l].loadState(in);
+	in.seekg(posConnects + sizeConnects + sizeLines);
+	
+	tMD = tIn;
+	for (int ii=0; ii<6; ii++) FlinesS[ii] = FlinesIn[ii];
+	memcpy(states, &statesIn[0], nX*sizeof(double));
+	
+	// refresh the line internals from the restored states, then restore the SYNCOM histories 
+	// (the RHS evaluation would otherwise advance them)
+	RHSmaster(states, f0, tMD, dtM0);
+	
+	for (int l=0; l<nLines; l++)
+		LineList[l].loadState(linesIn);
+	return 0;
+}
+
+// save the model state to a checkpoint file (see saveState)
+int MoorDynSystem::SaveCheckpoint(const char* path)
+{
+	ofstream ckfile(path, ios::out | ios::binary);
+	if (!ckfile.is_open())
+	{
+		cout << "   Error: unable to write checkpoint file " << path << endl;
+		return -1;
+	}
+	
+	saveState(ckfile);
+	
+	if (!ckfile)
+	{
+		cout << "   Error: failed writing checkpoint file " << path << endl;
+		return -1;
+	}
+	ckfile.close();
+	return 0;
+}
+
+// restore a checkpoint saved with SaveCheckpoint.  LinesInit must have been called with the same input files.
+int MoorDynSystem::LoadCheckpoint(const char* path)
+{
+	ifstream ckfile(path, ios::in | ios::binary);
+	if (!ckfile.is_open())
+	{
+		cout << "   Error: unable to open checkpoint file " << path << endl;
+		return -1;
+	}
+	
+	int err = loadState(ckfile);
+	if (err == 1)
+		cout << "   Error: " << path << " is not a supported checkpoint file" << endl;
+	else if (err == 2)
+		cout << "   Error: checkpoint " << path << " does not match the current mooring system" << endl;
+	else if (err == 3)
+		cout << "   Error: checkpoint " << path << " is incomplete" << endl;
+	
+	return err ? -1 : 0;
+}
+
 //===============================================================================
 //------------------------- SYNCOM Modifications---------------------------------
-int DECLDIR SC_GetEpsFL(int LineNum, double eps[])
+int MoorDynSystem::SC_GetEpsFL(int LineNum, double eps[])
 {
 	// output LINE fairlead (top end) stress and deformations
 	if ((LineNum > 0) && (LineNum <= nLines)) {
@@ -1608,3 +2500,355 @@ int DECLDIR SC_GetEpsFL(int LineNum, double eps[])
 //===============================================================================
 //------------------------- End Modifications---------------------------------
 
+
+// fill buffer[] with the profile (layout in MoorDyn.h).  Returns the number of values written, the
+// number of values needed if buffer is NULL, or -1 if size is too small.
+int MoorDynSystem::GetProfile(double buffer[], int size)
+{
+	int n = 2*PROF_NSYS + nLines*(2*LPROF_NLINE + LPROF_NITER + 1);
+	if (buffer == NULL)
+		return n;
+	if (size < n)
+		return -1;
+	
+	int i = 0;
+	for (int k=0; k<PROF_NSYS; k++)
+	{
+		buffer[i++] = prof[k].time;
+		buffer[i++] = prof[k].count;
+	}
+	for (int l=0; l<nLines; l++)
+	{
+		const ProfTimer* lprof = LineList[l].getProfile();
+		const long* hist = LineList[l].getNewtonHist();
+		for (int k=0; k<LPROF_NLINE; k++)
+		{
+			buffer[i++] = lprof[k].time;
+			buffer[i++] = lprof[k].count;
+		}
+		for (int k=0; k<LPROF_NITER; k++)
+			buffer[i++] = hist[k];
+		buffer[i++] = LineList[l].getSCreused();
+	}
+	return n;
+}
+
+// write a summary of the profile to the console
+void MoorDynSystem::printProfile(void)
+{
+	const char* sysNames[PROF_NSYS] = {"fairlead update", "connections", "lines", "time integration", 
+	                                   "coupling steps", "output", "IC generation"};
+	const char* lineNames[LPROF_NLINE] = {"kinematics", "waves", "mass matrix", "segment forces", 
+	                                      "  SYNCOM solves", "node forces", "state update"};
+	
+	cout << "   Profile (wall time, calls):" << endl;
+	for (int k=0; k<PROF_NSYS; k++)
+		cout << "     " << left << setw(18) << sysNames[k] << right << setw(12) << fixed << setprecision(4) 
+		     << prof[k].time << " s " << setw(12) << prof[k].count << endl;
+	
+	for (int l=0; l<nLines; l++)
+	{
+		const ProfTimer* lprof = LineList[l].getProfile();
+		const long* hist = LineList[l].getNewtonHist();
+		cout << "   Line " << l+1 << ":" << endl;
+		for (int k=0; k<LPROF_NLINE; k++)
+			cout << "     " << left << setw(18) << lineNames[k] << right << setw(12) << fixed << setprecision(4) 
+			     << lprof[k].time << " s " << setw(12) << lprof[k].count << endl;
+		
+		long nSolves = 0;
+		for (int k=0; k<LPROF_NITER; k++)  nSolves += hist[k];
+		if (nSolves > 0)
+		{
+			cout << "     Newton iterations:";
+			for (int k=0; k<LPROF_NITER; k++)
+				if (hist[k] > 0)
+					cout << " " << k << ((k == LPROF_NITER-1) ? "+" : "") << ":" << hist[k];
+			cout << endl;
+		}
+		long nReused = LineList[l].getSCreused();
+		if (nReused > 0)
+			cout << "     SYNCOM evaluations reused: " << nReused << " (" << setprecision(1) 
+			     << 100.0*nReused/(nSolves + nReused) << "% skipped)" << endl;
+	}
+	cout.unsetf(ios::floatfield);
+	cout << setprecision(6);
+}
+
+
+// ------------------------------- classic interface (default system) -------------------------------
+
+int DECLDIR LinesInit(double X[], double XD[])
+{
+	delete defaultSystem;
+	defaultSystem = new MoorDynSystem("Mooring/lines.txt");
+	return defaultSystem->LinesInit(X, XD);
+}
+
+int DECLDIR LinesCalc(double X[], double XD[], double Flines[], double* t_in, double* dt_in)
+{
+	if (defaultSystem == NULL)  return -1;
+	return defaultSystem->LinesCalc(X, XD, Flines, t_in, dt_in);
+}
+
+int DECLDIR FairleadsCalc(double **rFairIn, double **rdFairIn, double ** fFairIn, double* t_in, double *dt_in)
+{
+	if (defaultSystem == NULL)  return -1;
+	return defaultSystem->FairleadsCalc(rFairIn, rdFairIn, fFairIn, t_in, dt_in);
+}
+
+int DECLDIR LinesCalcTrajectory(const double* X, const double* XD, const double* t, size_t n, 
+	double* Flines_out, double* fairTen_out, double* epsFL_out)
+{
+	if (defaultSystem == NULL)  return -1;
+	return defaultSystem->LinesCalcTrajectory(X, XD, t, n, Flines_out, fairTen_out, epsFL_out);
+}
+
+int DECLDIR LinesCalcAsync(double X[], double XD[], double* t_in, double* dt_in)
+{
+	if (defaultSystem == NULL)  return -1;
+	return defaultSystem->LinesCalcAsync(X, XD, t_in, dt_in);
+}
+
+int DECLDIR LinesCalcWait(double X[], double XD[], double Flines[])
+{
+	if (defaultSystem == NULL)  return -1;
+	return defaultSystem->LinesCalcWait(X, XD, Flines);
+}
+
+int DECLDIR LinesClose(void)
+{
+	if (defaultSystem == NULL)  return 0;
+	int err = defaultSystem->LinesClose();
+	delete defaultSystem;
+	defaultSystem = NULL;
+	return err;
+}
+
+double DECLDIR GetFairTen(int l)
+{
+	if (defaultSystem == NULL)  return -1;
+	return defaultSystem->GetFairTen(l);
+}
+
+int DECLDIR GetFASTtens(int* numLines, float FairHTen[], float FairVTen[], float AnchHTen[], float AnchVTen[] )
+{
+	if (defaultSystem == NULL)  return -1;
+	return defaultSystem->GetFASTtens(numLines, FairHTen, FairVTen, AnchHTen, AnchVTen);
+}
+
+int DECLDIR GetConnectPos(int l, double pos[3])
+{
+	if (defaultSystem == NULL)  return -1;
+	return defaultSystem->GetConnectPos(l, pos);
+}
+
+int DECLDIR GetConnectForce(int l, double force[3])
+{
+	if (defaultSystem == NULL)  return -1;
+	return defaultSystem->GetConnectForce(l, force);
+}
+
+int DECLDIR GetNodePos(int LineNum, int NodeNum, double pos[3])
+{
+	if (defaultSystem == NULL)  return -1;
+	return defaultSystem->GetNodePos(LineNum, NodeNum, pos);
+}
+
+int DECLDIR GetNodePos_v2(int LineNum, int NodeNum, double pos[3])
+{
+	if (defaultSystem == NULL)  return -1;
+	return defaultSystem->GetNodePos_v2(LineNum, NodeNum, pos);
+}
+
+int DECLDIR DrawWithGL(void)
+{
+	if (defaultSystem == NULL)  return -1;
+	return defaultSystem->DrawWithGL();
+}
+
+int DECLDIR GetLineN(int LineNum)
+{
+	if (defaultSystem == NULL)  return -1;
+	return defaultSystem->GetLineN(LineNum);
+}
+
+int DECLDIR GetLineData(int LineNum, int field, double out[])
+{
+	if (defaultSystem == NULL)  return -1;
+	return defaultSystem->GetLineData(LineNum, field, out);
+}
+
+const double* DECLDIR GetStateArray(int* nStates)
+{
+	if (defaultSystem == NULL)  return NULL;
+	return defaultSystem->GetStateArray(nStates);
+}
+
+int DECLDIR GetLineStateIndex(int LineNum)
+{
+	if (defaultSystem == NULL)  return -1;
+	return defaultSystem->GetLineStateIndex(LineNum);
+}
+
+void AllOutput(double t, double dtC)
+{
+	if (defaultSystem != NULL)
+		defaultSystem->AllOutput(t, dtC);
+}
+
+int SetupWavesFromFile(void)
+{
+	if (defaultSystem == NULL)  return -1;
+	return defaultSystem->SetupWavesFromFile();
+}
+
+int DECLDIR SaveCheckpoint(const char* path)
+{
+	if (defaultSystem == NULL)  return -1;
+	return defaultSystem->SaveCheckpoint(path);
+}
+
+int DECLDIR LoadCheckpoint(const char* path)
+{
+	if (defaultSystem == NULL)  return -1;
+	return defaultSystem->LoadCheckpoint(path);
+}
+
+int DECLDIR SC_GetEpsFL(int LineNum, double eps[])
+{
+	if (defaultSystem == NULL)  return -1;
+	return defaultSystem->SC_GetEpsFL(LineNum, eps);
+}
+
+int DECLDIR GetProfile(double buffer[], int size)
+{
+	if (defaultSystem == NULL)  return -1;
+	return defaultSystem->GetProfile(buffer, size);
+}
+
+
+// ------------------------------- handle-based interface -------------------------------
+// Each handle is an independent mooring system (see MoorDynSystem.h).  Different handles can be 
+// used from different threads at the same time; a single handle must not be used concurrently.
+
+MoorDynHandle DECLDIR MoorDyn_Create(const char* inputFile)
+{
+	if (inputFile == NULL)  return NULL;
+	return (MoorDynHandle) new MoorDynSystem(inputFile);
+}
+
+int DECLDIR MoorDyn_Init(MoorDynHandle system, double X[], double XD[])
+{
+	if (system == NULL)  return -1;
+	return ((MoorDynSystem*)system)->LinesInit(X, XD);
+}
+
+int DECLDIR MoorDyn_Step(MoorDynHandle system, double X[], double XD[], double Flines[], double* t_in, double* dt_in)
+{
+	if (system == NULL)  return -1;
+	return ((MoorDynSystem*)system)->LinesCalc(X, XD, Flines, t_in, dt_in);
+}
+
+int DECLDIR MoorDyn_StepFairleads(MoorDynHandle system, double **rFairIn, double **rdFairIn, double ** fFairIn, double* t_in, double *dt_in)
+{
+	if (system == NULL)  return -1;
+	return ((MoorDynSystem*)system)->FairleadsCalc(rFairIn, rdFairIn, fFairIn, t_in, dt_in);
+}
+
+int DECLDIR MoorDyn_StepTrajectory(MoorDynHandle system, const double* X, const double* XD, const double* t, size_t n, 
+	double* Flines_out, double* fairTen_out, double* epsFL_out)
+{
+	if (system == NULL)  return -1;
+	return ((MoorDynSystem*)system)->LinesCalcTrajectory(X, XD, t, n, Flines_out, fairTen_out, epsFL_out);
+}
+
+int DECLDIR MoorDyn_StepAsync(MoorDynHandle system, double X[], double XD[], double* t_in, double* dt_in)
+{
+	if (system == NULL)  return -1;
+	return ((MoorDynSystem*)system)->LinesCalcAsync(X, XD, t_in, dt_in);
+}
+
+int DECLDIR MoorDyn_StepWait(MoorDynHandle system, double X[], double XD[], double Flines[])
+{
+	if (system == NULL)  return -1;
+	return ((MoorDynSystem*)system)->LinesCalcWait(X, XD, Flines);
+}
+
+int DECLDIR MoorDyn_Destroy(MoorDynHandle system)
+{
+	if (system == NULL)  return -1;
+	delete (MoorDynSystem*)system;		// (closes the system if it was initialized)
+	return 0;
+}
+
+double DECLDIR MoorDyn_GetFairTen(MoorDynHandle system, int l)
+{
+	if (system == NULL)  return -1;
+	return ((MoorDynSystem*)system)->GetFairTen(l);
+}
+
+int DECLDIR MoorDyn_GetConnectPos(MoorDynHandle system, int l, double pos[3])
+{
+	if (system == NULL)  return -1;
+	return ((MoorDynSystem*)system)->GetConnectPos(l, pos);
+}
+
+int DECLDIR MoorDyn_GetConnectForce(MoorDynHandle system, int l, double force[3])
+{
+	if (system == NULL)  return -1;
+	return ((MoorDynSystem*)system)->GetConnectForce(l, force);
+}
+
+int DECLDIR MoorDyn_GetNodePos(MoorDynHandle system, int LineNum, int NodeNum, double pos[3])
+{
+	if (system == NULL)  return -1;
+	return ((MoorDynSystem*)system)->GetNodePos_v2(LineNum, NodeNum, pos);
+}
+
+int DECLDIR MoorDyn_GetLineN(MoorDynHandle system, int LineNum)
+{
+	if (system == NULL)  return -1;
+	return ((MoorDynSystem*)system)->GetLineN(LineNum);
+}
+
+int DECLDIR MoorDyn_GetLineData(MoorDynHandle system, int LineNum, int field, double out[])
+{
+	if (system == NULL)  return -1;
+	return ((MoorDynSystem*)system)->GetLineData(LineNum, field, out);
+}
+
+const double* DECLDIR MoorDyn_GetStateArray(MoorDynHandle system, int* nStates)
+{
+	if (system == NULL)  return NULL;
+	return ((MoorDynSystem*)system)->GetStateArray(nStates);
+}
+
+int DECLDIR MoorDyn_GetLineStateIndex(MoorDynHandle system, int LineNum)
+{
+	if (system == NULL)  return -1;
+	return ((MoorDynSystem*)system)->GetLineStateIndex(LineNum);
+}
+
+int DECLDIR MoorDyn_SaveCheckpoint(MoorDynHandle system, const char* path)
+{
+	if (system == NULL)  return -1;
+	return ((MoorDynSystem*)system)->SaveCheckpoint(path);
+}
+
+int DECLDIR MoorDyn_LoadCheckpoint(MoorDynHandle system, const char* path)
+{
+	if (system == NULL)  return -1;
+	return ((MoorDynSystem*)system)->LoadCheckpoint(path);
+}
+
+int DECLDIR MoorDyn_SC_GetEpsFL(MoorDynHandle system, int LineNum, double eps[])
+{
+	if (system == NULL)  return -1;
+	return ((MoorDynSystem*)system)->SC_GetEpsFL(LineNum, eps);
+}
+
+int DECLDIR MoorDyn_GetProfile(MoorDynHandle system, double buffer[], int size)
+{
+	if (system == NULL)  return -1;
+	return ((MoorDynSystem*)system)->GetProfile(buffer, size);
+}
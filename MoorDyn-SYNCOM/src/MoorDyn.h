@@ -27,6 +27,8 @@
 	#define DECLDIR //__declspec(dllimport)
 #endif
 
+#include <stddef.h>
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -44,6 +46,17 @@ int DECLDIR LinesCalc(double X[], double XD[], double Flines[], double* , double
 
 int DECLDIR FairleadsCalc(double **rFairIn, double **rdFairIn, double ** fFairIn, double* t_in, double *dt_in);
 
+// steps through a prescribed motion history: X, XD are n x 6 (row per step, starting at time t[i], increasing),
+// outputs are n x 6 loads, and n x nLines top tensions and SYNCOM fairlead strains (each may be NULL)
+int DECLDIR LinesCalcTrajectory(const double* X, const double* XD, const double* t, size_t n, 
+	double* Flines_out, double* fairTen_out, double* epsFL_out);
+
+// asynchronous coupling: LinesCalcAsync starts a step with predicted platform kinematics on a worker 
+// thread and returns at once; LinesCalcWait takes the actual kinematics (or NULL to accept the 
+// prediction), redoes the step if the fairleads deviate by more than AsyncTol and returns the loads
+int DECLDIR LinesCalcAsync(double X[], double XD[], double* t, double* dt);
+int DECLDIR LinesCalcWait(double X[], double XD[], double Flines[]);
+
 int DECLDIR LinesClose(void);
 
 double DECLDIR GetFairTen(int);
@@ -57,11 +70,88 @@ int DECLDIR GetNodePos_v2(int LineNum, int NodeNum, double pos[3]);
 
 int DECLDIR DrawWithGL(void);
 
+// bulk line data: GetLineData fills out[] with one of the quantities below for all nodes or segments of
+// line LineNum, or of all lines in order (LineNum = 0), and returns the number of values written.
+// GetLineN gives the number of segments N (total over all lines for LineNum = 0).
+#define MD_NODE_POS        0	// node positions, 3*(N+1) values (x/y/z per node)
+#define MD_NODE_VEL        1	// node velocities, 3*(N+1) values
+#define MD_SEG_TEN         2	// segment tension magnitudes (N), N values
+#define MD_SEG_STRAIN      3	// segment strains, N values
+#define MD_SC_STRESS       4	// SYNCOM segment stress / MBL, N values (zero for non-SYNCOM lines)
+#define MD_SC_EPS_VP       5	// SYNCOM segment viscoplastic strain, N values
+#define MD_SC_SIGMA_YIELD  6	// SYNCOM segment yield stress / MBL, N values
+
+int DECLDIR GetLineN(int LineNum);
+int DECLDIR GetLineData(int LineNum, int field, double out[]);
+
+// read-only view of the state vector (valid from LinesInit to LinesClose)
+const double* DECLDIR GetStateArray(int* nStates);
+int DECLDIR GetLineStateIndex(int LineNum);
+
+int DECLDIR SaveCheckpoint(const char* path);
+int DECLDIR LoadCheckpoint(const char* path);
+
 void AllOutput(double, double);
 int SetupWavesFromFile(void);
 
 int DECLDIR SC_GetEpsFL(int LineNum, double stressStrain[2]);
 
+// phase profile (solver option Profile = 1).  GetProfile fills buffer[] with (wall time in s, number of
+// calls) pairs for the MD_PROF_NSYS system phases below, followed for each line by the pairs of its
+// MD_PROF_NLINE RHS sections and its MD_PROF_NITER Newton iteration counts (number of SYNCOM solves that
+// took 0, 1, ... iterations, the last bin collecting the rest) and its number of SYNCOM evaluations reused
+// for quiescent segments (solver option SCskipTol), MD_PROF_LINESIZE values in all.  Returns the number
+// of values written, the number needed if buffer is NULL, or -1 if size is too small.  A summary is
+// printed by LinesClose.
+#define MD_PROF_FAIRLEADS  0	// fairlead kinematics extrapolation
+#define MD_PROF_CONNECTS   1	// connection forces and dynamics
+#define MD_PROF_LINES      2	// line dynamics (all lines)
+#define MD_PROF_TIMESTEP   3	// time integration over the coupling steps
+#define MD_PROF_COUPLING   4	// coupling steps (LinesCalc, including integration and output)
+#define MD_PROF_OUTPUT     5	// output writing
+#define MD_PROF_ICGEN      6	// IC generation
+#define MD_PROF_NSYS       7
+
+#define MD_PROF_KIN        0	// node states, segment lengths and tangents
+#define MD_PROF_WAVES      1	// wave kinematics interpolation
+#define MD_PROF_MASS       2	// node mass matrices
+#define MD_PROF_SEGS       3	// segment tension and damping (including the SYNCOM solves)
+#define MD_PROF_SYNCOM     4	// SYNCOM solves alone
+#define MD_PROF_NODES      5	// hydrodynamic, weight and bottom contact forces
+#define MD_PROF_STATES     6	// state derivatives and SYNCOM parameter update
+#define MD_PROF_NLINE      7
+#define MD_PROF_NITER      16
+#define MD_PROF_LINESIZE   (2*MD_PROF_NLINE + MD_PROF_NITER + 1)	// values per line
+
+int DECLDIR GetProfile(double buffer[], int size);
+
+// handle-based interface: each handle is an independent mooring system whose input file is given 
+// at creation (output files are written to the folder of the input file)
+typedef void* MoorDynHandle;
+
+MoorDynHandle DECLDIR MoorDyn_Create(const char* inputFile);
+int DECLDIR MoorDyn_Init(MoorDynHandle system, double X[], double XD[]);
+int DECLDIR MoorDyn_Step(MoorDynHandle system, double X[], double XD[], double Flines[], double* t, double* dt);
+int DECLDIR MoorDyn_StepFairleads(MoorDynHandle system, double **rFairIn, double **rdFairIn, double ** fFairIn, double* t, double* dt);
+int DECLDIR MoorDyn_StepTrajectory(MoorDynHandle system, const double* X, const double* XD, const double* t, size_t n, 
+	double* Flines_out, double* fairTen_out, double* epsFL_out);
+int DECLDIR MoorDyn_StepAsync(MoorDynHandle system, double X[], double XD[], double* t, double* dt);
+int DECLDIR MoorDyn_StepWait(MoorDynHandle system, double X[], double XD[], double Flines[]);
+int DECLDIR MoorDyn_Destroy(MoorDynHandle system);
+
+double DECLDIR MoorDyn_GetFairTen(MoorDynHandle system, int l);
+int DECLDIR MoorDyn_GetConnectPos(MoorDynHandle system, int l, double pos[3]);
+int DECLDIR MoorDyn_GetConnectForce(MoorDynHandle system, int l, double force[3]);
+int DECLDIR MoorDyn_GetNodePos(MoorDynHandle system, int LineNum, int NodeNum, double pos[3]);
+int DECLDIR MoorDyn_GetLineN(MoorDynHandle system, int LineNum);
+int DECLDIR MoorDyn_GetLineData(MoorDynHandle system, int LineNum, int field, double out[]);
+const double* DECLDIR MoorDyn_GetStateArray(MoorDynHandle system, int* nStates);
+int DECLDIR MoorDyn_GetLineStateIndex(MoorDynHandle system, int LineNum);
+int DECLDIR MoorDyn_SaveCheckpoint(MoorDynHandle system, const char* path);
+int DECLDIR MoorDyn_LoadCheckpoint(MoorDynHandle system, const char* path);
+int DECLDIR MoorDyn_SC_GetEpsFL(MoorDynHandle system, int LineNum, double stressStrain[2]);
+int DECLDIR MoorDyn_GetProfile(MoorDynHandle system, double buffer[], int size);
+
 #ifdef __cplusplus
 }
 #endif
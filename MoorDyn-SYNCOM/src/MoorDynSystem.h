@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2014 Matt Hall <mtjhall@alumni.uvic.ca>
+ *
+ * This file is part of MoorDyn.  MoorDyn is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * MoorDyn is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MoorDyn.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MOORDYNSYSTEM_H
+#define MOORDYNSYSTEM_H
+
+#include "Misc.h"
+#include "Line.h"
+#include "Connection.h"
+#include "OutputWriter.h"
+#include "Profiler.h"
+#include <thread>
+#include <sstream>
+
+using namespace std;
+
+// One complete mooring system: the line and connection objects, the global state vector, the solver
+// options and the output files.  Independent systems can be created and stepped in the same process
+// (also from different threads).  The classic LinesInit/LinesCalc/... interface uses a default system.
+// All files of a system are read from/written to the folder of its input file (MaterDef.xml and
+// waves.txt are read from the working folder if they are not there).
+
+class MoorDynSystem
+{
+public:
+	string inputFile;			// path of the input file (lines.txt)
+	string outDir;				// folder of the input file, used for all output and cache files
+	int initialized = 0;		// set by LinesInit, cleared by LinesClose
+
+	// static vectors for fairleads
+	vector<double> FlinesS;					// net line force vector (6-DOF) - retains last solution for use when inputted dt is zero (such as during FAST predictor steps) when the model does not time step
+	vector< vector< double > > rFairtS;		// fairlead locations in turbine/platform coordinates
+	vector< vector< double > > rFairRel;		// fairlead locations relative to platform ref point but in inertial orientation
+	double** rFairi = NULL;			// fairlead locations in inertial reference frame
+	double** rdFairi = NULL;		// fairlead velocities in inertial reference frame
+
+	// vectors to hold line and connection objects
+	vector< LineProps > LinePropList; 			// to hold line library types
+	vector< Line > LineList; 				// line objects
+	vector< Connection > ConnectList;			// connection objects (line joints or ends)
+	int nLines = 0;							// number of line objects
+	int nConnects = 0; 						// total number of Connection objects
+	int nFairs  = 0;							// number of fairlead connections
+	int nAnchs  = 0;							// number of anchor connections
+	int nConns  = 0;							// number of "connect" connections
+
+	vector< int > FairIs;  					// vector of fairlead connection indices in ConnectList vector
+	vector< int > ConnIs;  					// vector of connect connection indices in ConnectList vector
+	EnvCond env; 							// struct of general environmental parameters
+	vector< shared_ptr< ofstream > > outfiles; 	// a vector to hold ofstreams for each line
+	ofstream outfileMain;					// main output file
+	vector< OutChanProps > outChans;		// list of structs describing selected output channels for main out file
+	shared_ptr< OutputWriter > outWriterMain;		// buffered background writer for the main output file
+	vector< shared_ptr< OutputWriter > > outWriters;	// buffered background writers for each line's output file (NULL if none)
+	int OutFormat = 0;						// output data layout: 0 = text (.out), 1 = binary (.bin, with the .out file holding the header)
+
+	// state vector and stuff
+	double* states = NULL; 					// pointer to array comprising global state vector
+	int nX = 0; 							// size of state vector array
+	double* xt = NULL; 						// more state vector things for rk2/rk4 integration
+	double* f0 = NULL;
+	double* f1 = NULL;
+
+	double** Ffair = NULL;	// pointer to 2-d array holding fairlead forces
+
+	vector< int > LineStateIs;  // vector of line starting indices in "states" array
+
+	double dtM0 = 0.001; // desired mooring line model time step
+
+	double dtOut = 0;  // (s) desired output interval (the default zero value provides output at every call to MoorDyn)
+
+	int Integrator = 0;  // time integration scheme: 0 = RK2 (default), 1 = semi-implicit Euler (allows dtM up to the coupling time step)
+
+	int SCrate = 1;       // SYNCOM multi-rate: max number of line RHS calls between SYNCOM state updates (1 = every call)
+	double SCdEps = 0.0;  // SYNCOM multi-rate: segment strain increment that triggers an update (0 = off)
+	double SCskipTol = 0.0;  // strain change below which a segment's last SYNCOM evaluation is reused (0 = off)
+	int SCskipMax = 10;      // max number of consecutive reuses of a SYNCOM evaluation
+
+	int dtMauto = 0;      // flag to pick the mooring time step from the CFL limit of the lines instead of dtM0
+	double CFLfac = 0.5;  // safety factor applied to the CFL-limited time step
+	vector< double > dtMline;  // latest CFL-limited time step of each line (s)
+
+	int LocalDt = 0;      // flag for per-line sub-cycling: each line takes its own CFL-limited step within the coupling step
+	vector< int > NdtLine;         // number of time steps of each line in the current coupling step
+	vector< int > lineSubcycled;   // 1 if the line is advanced separately from the connections in the current coupling step
+
+	int ICgen = 0;        // IC generation scheme: 0 = dynamic relaxation with boosted drag, 1 = kinetic damping
+	int ICcache = 0;      // flag to store/reuse the converged ICs (states and SYNCOM histories) on disk
+
+	double tMD = 0.0;     // time reached by the mooring model (stored in checkpoints)
+
+	// asynchronous coupling (LinesCalcAsync/LinesCalcWait)
+	double AsyncTol = 0.01;   // fairlead deviation (m) between predicted and actual kinematics that makes a step be redone
+	thread asyncThread;       // worker running the pending step
+	int asyncBusy = 0;        // 1 while a step is pending
+	int asyncErr = 0;         // return value of the pending step
+	double asyncX[6];         // predicted platform kinematics, time and coupling step of the pending step
+	double asyncXD[6];
+	double asyncT = 0.0;
+	double asyncDt = 0.0;
+	double asyncF[6];         // resulting platform loads
+	stringstream asyncSnapshot;  // state before the pending step
+	int asyncSteps = 0;       // statistics
+	int asyncRedone = 0;
+	int skipOutput = 0;       // suppresses output writing in FairleadsCalc
+
+	// coupling trace (every call of the coupling functions is logged to Lines.trace for replay)
+	int RecordTrace = 0;      // flag to record the coupling trace
+	ofstream traceFile;
+	int traceSuspend = 0;     // > 0 while the coupling functions are called internally (not recorded)
+
+	// profiling
+	int Profile = 0;          // flag to time the solver phases, line sections and SYNCOM solves
+	ProfTimer prof[PROF_NSYS];  // timers of the system phases (the line timers are kept by each line)
+
+	// new temporary additions for waves
+	vector< floatC > zetaCglobal;
+	double dwW = 0.0;
+
+
+	MoorDynSystem(const char* inputFile_in);
+	~MoorDynSystem();
+
+	// time integration
+	void RHSmaster( const double X[],  double Xd[], const double t, double dt);
+	void rk2 (double x0[], double *t0, double dt );
+	void sie (double x0[], double *t0, double dt );
+	double MaxTimeStep (void);
+	void LocalTimeStep (double x0[], double *t0, double dtC, int NdtM );
+	void TimeStep (double x0[], double *t0, double dt );
+
+	// output
+	double GetOutput(OutChanProps outChan);
+	void AllOutput(double t, double dtC);
+
+	// IC cache
+	uint64_t ICcacheHash(const double X[]);
+	string ICcacheName(uint64_t ICHash);
+	int readICcache(uint64_t ICHash, double dtM);
+	void writeICcache(uint64_t ICHash);
+
+	// coupling trace
+	void traceOpen(const double X[], const double XD[]);
+	void traceWrite(char type, const double* data, int n);
+	int traceOn(void) { return traceFile.is_open() && (traceSuspend == 0); };
+
+	// main interface (see the exported functions of the same names in MoorDyn.h)
+	int LinesInit(double X[], double XD[]);
+	int SetupWavesFromFile(void);
+	int LinesCalc(double X[], double XD[], double Flines[], double* t_in, double* dt_in);
+	int FairleadsCalc(double **rFairIn, double **rdFairIn, double ** fFairIn, double* t_in, double *dt_in);
+	int LinesCalcAsync(double X[], double XD[], double* t_in, double* dt_in);
+	int LinesCalcWait(double X[], double XD[], double Flines[]);
+	void asyncStep(void);
+	void fairleadPath(const double X[], const double XD[], double dtC, vector<double>& rOut);
+	int LinesCalcTrajectory(const double* X, const double* XD, const double* t, size_t n, 
+		double* Flines_out, double* fairTen_out, double* epsFL_out);
+	int LinesClose(void);
+
+	double GetFairTen(int l);
+	int GetFASTtens(int* numLines, float FairHTen[], float FairVTen[], float AnchHTen[], float AnchVTen[] );
+	int GetConnectPos(int l, double pos[3]);
+	int GetConnectForce(int l, double force[3]);
+	int GetNodePos(int LineNum, int NodeNum, double pos[3]);
+	int GetNodePos_v2(int LineNum, int NodeNum, double pos[3]);
+	int DrawWithGL(void);
+
+	int GetLineN(int LineNum);
+	int GetLineData(int LineNum, int field, double out[]);
+	const double* GetStateArray(int* nStates);
+	int GetLineStateIndex(int LineNum);
+
+	void saveState(ostream& out);
+	int loadState(istream& in);
+	int SaveCheckpoint(const char* path);
+	int LoadCheckpoint(const char* path);
+
+	int SC_GetEpsFL(int LineNum, double eps[]);
+
+	int GetProfile(double buffer[], int size);
+	void printProfile(void);
+};
+
+#endif
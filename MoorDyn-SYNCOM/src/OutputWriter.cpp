@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2014 Matt Hall <mtjhall@alumni.uvic.ca>
+ * 
+ * This file is part of MoorDyn.  MoorDyn is free software: you can redistribute 
+ * it and/or modify it under the terms of the GNU General Public License as 
+ * published by the Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ * 
+ * MoorDyn is distributed in the hope that it will be useful, but WITHOUT ANY 
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS 
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with MoorDyn.  If not, see <http://www.gnu.org/licenses/>.
+ */
+ 
+#include "OutputWriter.h"
+
+using namespace std;
+
+
+OutputWriter::OutputWriter()
+{
+	textfile = NULL;
+	binary = 0;
+	rowSize = 0;
+	nRows = 0;
+	head = 0;
+	tail = 0;
+	closing = 0;
+}
+
+
+OutputWriter::~OutputWriter()
+{
+	close();
+}
+
+
+// allocate the ring buffer, open the binary file if needed and start the background thread.  Returns 0 on success.
+int OutputWriter::setup(ofstream* textfile_in, string binName, int rowSize_in, int binary_in, int nRows_in)
+{
+	textfile = textfile_in;
+	binary = binary_in;
+	rowSize = rowSize_in;
+	nRows = nRows_in;
+	head = 0;
+	tail = 0;
+	closing = 0;
+	
+	ring.assign(nRows*rowSize, 0.0);
+	
+	if (binary)
+	{
+		binfile.open(binName.c_str(), ios::out | ios::binary);
+		if (!binfile.is_open())
+		{
+			cout << "   Error: unable to open binary output file " << binName << endl;
+			return -1;
+		}
+		int32_t ncols = rowSize;
+		binfile.write("MDOB", 4);
+		binfile.write((char*)&ncols, sizeof(ncols));
+	}
+	else if ((textfile == NULL) || (!textfile->is_open()))
+	{
+		cout << "   Error: output file is not open" << endl;
+		return -1;
+	}
+	
+	worker = thread(&OutputWriter::writeLoop, this);
+	return 0;
+}
+
+
+// returns the ring buffer slot for the next row (waits if the writer thread is a full buffer behind)
+double* OutputWriter::beginRow(void)
+{
+	unique_lock<mutex> lock(mtx);
+	while (head - tail >= nRows)
+		cv.wait(lock);
+	
+	return &ring[(head % nRows)*rowSize];
+}
+
+
+// hands the row filled after beginRow over to the writer thread
+void OutputWriter::commitRow(void)
+{
+	{
+		lock_guard<mutex> lock(mtx);
+		head++;
+	}
+	cv.notify_all();
+}
+
+
+// background thread: write all committed rows, then wait for more
+void OutputWriter::writeLoop(void)
+{
+	unique_lock<mutex> lock(mtx);
+	while (true)
+	{
+		while ((tail == head) && (!closing))
+			cv.wait(lock);
+		
+		if ((tail == head) && closing)
+			break;
+		
+		long long last = head;		// rows up to here are complete and won't be touched by the simulation thread
+		long long next = tail;
+		lock.unlock();
+		
+		for (; next < last; next++)
+		{
+			const double* row = &ring[(next % nRows)*rowSize];
+			if (binary)
+				binfile.write((const char*)row, rowSize*sizeof(double));
+			else
+			{
+				for (int i=0; i<rowSize; i++)  *textfile << row[i] << "\t ";
+				*textfile << "\n";
+			}
+		}
+		
+		lock.lock();
+		tail = next;
+		cv.notify_all();
+	}
+	
+	if (binary)
+		binfile.flush();
+	else
+		textfile->flush();
+}
+
+
+// write any remaining rows and stop the background thread
+void OutputWriter::close(void)
+{
+	if (!worker.joinable())
+		return;
+	
+	{
+		lock_guard<mutex> lock(mtx);
+		closing = 1;
+	}
+	cv.notify_all();
+	worker.join();
+	
+	if (binfile.is_open())
+		binfile.close();
+}
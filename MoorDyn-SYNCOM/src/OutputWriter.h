@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2014 Matt Hall <mtjhall@alumni.uvic.ca>
+ * 
+ * This file is part of MoorDyn.  MoorDyn is free software: you can redistribute 
+ * it and/or modify it under the terms of the GNU General Public License as 
+ * published by the Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ * 
+ * MoorDyn is distributed in the hope that it will be useful, but WITHOUT ANY 
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS 
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with MoorDyn.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OUTPUTWRITER_H
+#define OUTPUTWRITER_H
+
+#include "Misc.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+using namespace std;
+
+// Buffered output for one output file.  The simulation thread copies each output row (time followed by 
+// the channel values) into a preallocated ring buffer, and a background thread formats and writes the rows, 
+// either in the usual tab-separated text layout (to the already opened .out file, after its header lines) 
+// or as raw doubles in a separate binary file (header: "MDOB", int32 number of values per row).
+
+class OutputWriter 
+{
+	ofstream* textfile;	// text output file (header lines already written), used in text mode
+	ofstream binfile;		// binary output file, used in binary mode
+	int binary;			// 0 = text layout, 1 = binary layout
+	
+	int rowSize;			// number of values per row (including time)
+	int nRows;			// capacity of the ring buffer (rows)
+	vector< double > ring;	// ring buffer of output rows
+	long long head;		// number of rows committed by the simulation thread
+	long long tail;		// number of rows written by the background thread
+	int closing;
+	
+	mutex mtx;
+	condition_variable cv;
+	thread worker;
+	
+	void writeLoop(void);
+	
+public:
+	OutputWriter();
+	~OutputWriter();
+	
+	int setup(ofstream* textfile_in, string binName, int rowSize_in, int binary_in, int nRows_in = 256);
+	
+	double* beginRow(void);
+	void commitRow(void);
+	
+	void close(void);
+};
+
+#endif
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2014 Matt Hall <mtjhall@alumni.uvic.ca>
+ *
+ * This file is part of MoorDyn.  MoorDyn is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * MoorDyn is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MoorDyn.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <chrono>
+
+// Lightweight phase profiler (enabled with the "Profile" solver option).  Each profiled section
+// accumulates its wall time and number of calls in a ProfTimer; a ProfScope measures one call.
+// When profiling is off the scopes are given a NULL timer and do nothing beyond a pointer check.
+
+struct ProfTimer
+{
+	double time = 0.0;	// accumulated wall time (s)
+	long count = 0;		// number of calls
+
+	void reset() { time = 0.0; count = 0; }
+};
+
+class ProfScope
+{
+	ProfTimer* timer;
+	std::chrono::steady_clock::time_point t0;
+
+public:
+	ProfScope(ProfTimer* timer_in) : timer(timer_in)
+	{
+		if (timer) t0 = std::chrono::steady_clock::now();
+	}
+	~ProfScope() { stop(); }
+
+	// ends the measurement before the end of the scope
+	void stop()
+	{
+		if (timer)
+		{
+			timer->time += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+			timer->count++;
+			timer = NULL;
+		}
+	}
+};
+
+// profiled phases of a mooring system (MoorDynSystem::prof)
+const int PROF_FAIRLEADS = 0;	// fairlead kinematics extrapolation in RHSmaster
+const int PROF_CONNECTS  = 1;	// connection forces and dynamics in RHSmaster
+const int PROF_LINES     = 2;	// line dynamics in RHSmaster
+const int PROF_TIMESTEP  = 3;	// time integration over the coupling steps (including the RHS calls)
+const int PROF_COUPLING  = 4;	// coupling steps (FairleadsCalc, including the time steps and output)
+const int PROF_OUTPUT    = 5;	// output (AllOutput)
+const int PROF_ICGEN     = 6;	// IC generation in LinesInit
+const int PROF_NSYS      = 7;
+
+// profiled sections of Line::doRHS (Line::prof)
+const int LPROF_KIN      = 0;	// node states, segment lengths and tangents
+const int LPROF_WAVES    = 1;	// wave kinematics interpolation
+const int LPROF_MASS     = 2;	// node mass matrices and their inverses
+const int LPROF_SEGS     = 3;	// segment tension and damping (including the SYNCOM solves)
+const int LPROF_SYNCOM   = 4;	// SYNCOM solves alone (stressSolver::syncom_solver)
+const int LPROF_NODES    = 5;	// weight, drag, Froude-Krylov and bottom contact forces
+const int LPROF_STATES   = 6;	// state derivatives and SYNCOM parameter update
+const int LPROF_NLINE    = 7;
+
+const int LPROF_NITER    = 16;	// bins of the Newton iteration histogram (the last one collects >= 15)
+
+#endif
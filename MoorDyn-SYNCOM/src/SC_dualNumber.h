@@ -0,0 +1,83 @@
+// SYNCOM - A Nonlinear Synthetic Rope Numerical Computation Software
+//
+// Copyright (c) 2020 Jessica Nguyen <nvnguyen@umass.edu>
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef SC_dualNumber_h
+#define SC_dualNumber_h
+
+#include <math.h>
+#include <vector>
+
+namespace rope {
+
+    ///////////////////////////////////////////////////////////////////////////////
+    /// Forward-mode dual number: value v and first derivative d WRT the applied
+    /// stress. Expressions evaluated on Dual give the exact derivative along with
+    /// the value, so the Newton derivative DFunc needs no hand-written terms;
+    ///////////////////////////////////////////////////////////////////////////////
+    struct Dual {
+        double v, d;
+
+        Dual(double v_in = 0, double d_in = 0) : v(v_in), d(d_in) {}
+
+        friend Dual operator+(const Dual& a, const Dual& b) { return Dual(a.v + b.v, a.d + b.d); }
+        friend Dual operator+(const Dual& a, double b) { return Dual(a.v + b, a.d); }
+        friend Dual operator+(double a, const Dual& b) { return Dual(a + b.v, b.d); }
+
+        friend Dual operator-(const Dual& a) { return Dual(-a.v, -a.d); }
+        friend Dual operator-(const Dual& a, const Dual& b) { return Dual(a.v - b.v, a.d - b.d); }
+        friend Dual operator-(const Dual& a, double b) { return Dual(a.v - b, a.d); }
+        friend Dual operator-(double a, const Dual& b) { return Dual(a - b.v, -b.d); }
+
+        friend Dual operator*(const Dual& a, const Dual& b) { return Dual(a.v * b.v, a.d * b.v + a.v * b.d); }
+        friend Dual operator*(const Dual& a, double b) { return Dual(a.v * b, a.d * b); }
+        friend Dual operator*(double a, const Dual& b) { return Dual(a * b.v, a * b.d); }
+
+        friend Dual operator/(const Dual& a, const Dual& b) {
+            double r = a.v / b.v;
+            return Dual(r, (a.d - r * b.d) / b.v);
+        }
+        friend Dual operator/(const Dual& a, double b) { return Dual(a.v / b, a.d / b); }
+        friend Dual operator/(double a, const Dual& b) {
+            double r = a / b.v;
+            return Dual(r, -r * b.d / b.v);
+        }
+
+        // Found by argument-dependent lookup only, exp(double) is unaffected;
+        friend Dual exp(const Dual& a) {
+            double e = ::exp(a.v);
+            return Dual(e, e * a.d);
+        }
+    };
+
+    ///////////////////////////////////////////////////////////////////////////////
+    /// Evaluates the polynomial sum(coefs[begin + j] * x^j), j = 0 .. end - begin - 1,
+    /// in a single Horner pass. With x = Dual(sigma, 1) the value and its first
+    /// derivative come out together;
+    ///////////////////////////////////////////////////////////////////////////////
+    template<typename T>
+    inline T horner(const std::vector<double>& coefs, int begin, int end, const T& x) {
+
+        T p = 0.0;
+        for (int j = end - 1; j >= begin; j--)
+            p = p * x + coefs[j];
+        return p;
+    }
+
+} // End of namespace rope.
+
+#endif // SC_dualNumber_h
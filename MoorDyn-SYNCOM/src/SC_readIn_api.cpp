@@ -316,6 +316,17 @@ namespace rope {
         // Clear parameters;
         names.clear();
 
+        // Initial stress guess of the Newton solve (optional; 0: previous stress trend,
+        // 1: tangent predictor, 2: tangent predictor with extrapolation in time);
+        stressSolver.material_props->predictor = 0;
+        if (child_node->first_node("predictor") != 0) {
+            names.push_back("predictor");
+            if (!check_is_number(child_node, names))
+                return ErrorCode::MATERDEF_FILE_NAN_MATERIAL_PROPERTIES;
+            stressSolver.material_props->predictor = stoi(child_node->first_node("predictor")->value());
+            names.clear();
+        }
+
         return ErrorCode::SUCCESS;
     }
     ////////////////////////////////////////////////////////////////////////////////
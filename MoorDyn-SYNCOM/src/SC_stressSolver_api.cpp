@@ -17,6 +17,7 @@
 
 #include "SC_stressSolver_api.h"
 #include <iomanip>
+#include <algorithm>
 
 namespace rope {
     ///////////////////////////////////////////////////////////////////////////////
@@ -25,6 +26,8 @@ namespace rope {
     stressSolver::stressSolver(MatProps* mat_props) {
         material_props = mat_props;
         material_props->step_num = std::vector<int>(7, 0);
+        nIter = 0; reused = 0;
+        skip_tol = 0; skip_max = 0;
     };
 
     ErrorCode stressSolver::validate(void)
@@ -51,12 +54,12 @@ namespace rope {
         // Initializes zero variables and zero vectors;
         a0 = g0 = g1 = g2 = Ep = np = H_vp = 0;
         da0 = dg0 = dg1 = dg2 = dEp = dnp = dH_vp = 0;
-        d2a0 = d2g0 = d2g1 = d2g2 = d2Ep = d2np = d2H_vp = 0;
-        dPsy = d2Psy = d3Psy = 0;
+        dPsy = 0;
 
         // Nodal properties;
         te.resize(numNodes, 0.0);
         epsim1.resize(numNodes, 0.0);
+        epsim2.resize(numNodes, 0.0);
         sigmaim1.resize(numNodes, 0.0);
         sigmaim2.resize(numNodes, 0.0);
         g2im1.resize(numNodes, 1.0);
@@ -73,51 +76,67 @@ namespace rope {
         eps_Vtemp.resize(numNodes, 0.0);
         g2_Vtemp.resize(numNodes, 1.0);
         dPsy_Vtemp.resize(numNodes, 0.0);
+        stiff_Vtemp.resize(numNodes, 0.0);
+
+        skip_eps.resize(numNodes, 0.0);
+        skip_dt.resize(numNodes, 0.0);
+        skip_sigma.resize(numNodes, 0.0);
+        skip_stiff.resize(numNodes, 0.0);
+        skip_g2.resize(numNodes, 1.0);
+        skip_dPsy.resize(numNodes, 0.0);
+        skip_count.resize(numNodes, -1);
+
+        // Step function index of each material parameter and last piece of each node;
+        stepIndex[0].build(material_props->a0stress_lim, material_props->step_num[0], material_props->a0Coefs.size());
+        stepIndex[1].build(material_props->g0stress_lim, material_props->step_num[1], material_props->g0Coefs.size());
+        stepIndex[2].build(material_props->g1stress_lim, material_props->step_num[2], material_props->g1Coefs.size());
+        stepIndex[3].build(material_props->g2stress_lim, material_props->step_num[3], material_props->g2Coefs.size());
+        stepIndex[4].build(material_props->Epstress_lim, material_props->step_num[4], material_props->EpCoefs.size());
+        stepIndex[5].build(material_props->npstress_lim, material_props->step_num[5], material_props->npCoefs.size());
+        stepIndex[6].build(material_props->Hstress_lim, material_props->step_num[6], material_props->H_vpCoefs.size());
+        step_hint.resize(7 * numNodes, 0);
+        stiff_hint = 0;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////
+    /// Enables reuse of visco-elastic evaluations for quiescent nodes: a node whose
+    /// strain is within tol of its last full evaluation (same dt) is not solved
+    /// again for up to maxReuse calls. tol = 0 disables the reuse;
+    ///////////////////////////////////////////////////////////////////////////////
+    void stressSolver::set_skip(double tol, int maxReuse) {
+        skip_tol = tol;
+        skip_max = maxReuse;
+        std::fill(skip_count.begin(), skip_count.end(), -1);
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////
+    /// Evaluates one polynomial piece of a material parameter and, for nDeriv > 0,
+    /// its derivative WRT sigma in the same Horner pass;
+    ///////////////////////////////////////////////////////////////////////////////
+    void stressSolver::calPoly(std::vector<double>& xyzCoefs, int begin, int end,
+        double sigma, double& xyz, double& dxyz, int nDeriv) {
+
+        if (nDeriv > 0) {
+            Dual p = horner(xyzCoefs, begin, end, Dual(sigma, 1));
+            xyz = p.v; dxyz = p.d;
+        }
+        else
+            xyz = horner(xyzCoefs, begin, end, sigma);
     }
 
     ///////////////////////////////////////////////////////////////////////////////
     /// Evaluates the material parameters from the input polynomial coefficients;
     /// a0, g0, g1, g2, Ep, np, H; With Step Functions;
     ///////////////////////////////////////////////////////////////////////////////
-    int stressSolver::calCoeffs_step(int step_num, double sigma,
-        std::vector<std::vector<double>>& stress_lim, std::vector<double>& xyzCoefs,
-        double& xyz, double& dxyz, double& d2xyz) {
-
-        for (int i = 0; i < step_num; i++) {
-            if (i == 0 && sigma <= stress_lim[0][i]) {
-                for (int j = 0; j < stress_lim[1][i]; j++) {
-                    xyz += xyzCoefs[j] * pow(sigma, j);
-                    if (j > 0)
-                        dxyz += xyzCoefs[j] * j * pow(sigma, j - 1);
-                    if (j > 1)
-                        d2xyz += xyzCoefs[j] * j * (j - 1) * pow(sigma, j - 2);
-                }
-                return 0; // Success
-            }
-            else if (i == (step_num - 1) && sigma > stress_lim[0][i]) {
-                for (int j = stress_lim[1][i]; j < xyzCoefs.size(); j++) {
-                    jtemp = j - stress_lim[1][i];
-                    xyz += xyzCoefs[j] * pow(sigma, jtemp);
-                    if (jtemp > 0)
-                        dxyz += xyzCoefs[j] * jtemp * pow(sigma, jtemp - 1);
-                    if (jtemp > 1)
-                        d2xyz += xyzCoefs[j] * jtemp * (jtemp - 1) * pow(sigma, jtemp - 2);
-                }
-                return 0; // Success
-            }
-            else if (sigma > stress_lim[0][i] && sigma <= stress_lim[0][i + 1]) {
-                for (int j = stress_lim[1][i]; j < stress_lim[1][i + 1]; j++) {
-                    jtemp = j - stress_lim[1][i];
-                    xyz += xyzCoefs[j] * pow(sigma, jtemp);
-                    if (jtemp > 0)
-                        dxyz += xyzCoefs[j] * jtemp * pow(sigma, jtemp - 1);
-                    if (jtemp > 1)
-                        d2xyz += xyzCoefs[j] * jtemp * (jtemp - 1) * pow(sigma, jtemp - 2);
-                }
-                return 0; // Success
-            }
-        }
-        return 1; // Failed to find step limits;
+    int stressSolver::calCoeffs_step(const StepIndex& steps, int& hint, double sigma,
+        std::vector<double>& xyzCoefs, double& xyz, double& dxyz, int nDeriv) {
+
+        int k = steps.find(sigma, hint);
+        if (k < 0)
+            return 1; // Failed to find step limits;
+
+        calPoly(xyzCoefs, steps.first[k], steps.first[k + 1], sigma, xyz, dxyz, nDeriv);
+        return 0; // Success
     }
 
     ///////////////////////////////////////////////////////////////////////////////
@@ -125,188 +144,152 @@ namespace rope {
     /// a0, g0, g1, g2, Ep, np, H; No Step Function;
     ///////////////////////////////////////////////////////////////////////////////
     void stressSolver::calCoeffs_nostep(std::vector<double>& xyzCoefs, double& xyz,
-        double& dxyz, double& d2xyz, double sigma) {
-
-        for (int i = 0; i < xyzCoefs.size(); i++) {
-            xyz += xyzCoefs[i] * pow(sigma, i);
-            if (i > 0)
-                dxyz += xyzCoefs[i] * i * pow(sigma, i - 1);
-            if (i > 1)
-                d2xyz += xyzCoefs[i] * i * (i - 1) * pow(sigma, i - 2);
-        }
+        double& dxyz, double sigma, int nDeriv) {
+
+        calPoly(xyzCoefs, 0, (int)xyzCoefs.size(), sigma, xyz, dxyz, nDeriv);
     }
 
     ///////////////////////////////////////////////////////////////////////////////
     /// Evaluates the material parameters from the input polynomial coefficients;
-    /// a0, g0, g1, g2, Ep, np, H;
+    /// a0, g0, g1, g2, Ep, np, H, and, for nDeriv > 0, their first derivatives
+    /// (needed by the Newton solves, not by the values-only calls); hint holds the
+    /// step function pieces of the node found by the previous call;
     ///////////////////////////////////////////////////////////////////////////////
-    int stressSolver::calCoeffs(double sigma, double dt) {
+    int stressSolver::calCoeffs(double sigma, double dt, int nDeriv, int* hint) {
 
         /// Reset values of a0, g0, g1, g2, Ep, np, H_vp, and their derivatives;
         a0 = g0 = g1 = g2 = Ep = np = H_vp = 0;
-        da0 = dg0 = dg1 = dg2 = dEp = dnp = dH_vp = 0;
-        d2a0 = d2g0 = d2g1 = d2g2 = d2Ep = d2np = d2H_vp = flag = 0;
+        da0 = dg0 = dg1 = dg2 = dEp = dnp = dH_vp = flag = 0;
        
         /// Calculate a0, g0, g1, g2, Ep, np, H_vp, and their derivatives;
         // a0;
         if (material_props->step_num[0] == 0) {
-            calCoeffs_nostep(material_props->a0Coefs, a0, da0, d2a0, sigma);
+            calCoeffs_nostep(material_props->a0Coefs, a0, da0, sigma, nDeriv);
         }
         else {
-            flag = calCoeffs_step(material_props->step_num[0], sigma, 
-                material_props->a0stress_lim,
-                material_props->a0Coefs, a0, da0, d2a0);
+            flag = calCoeffs_step(stepIndex[0], hint[0], sigma,
+                material_props->a0Coefs, a0, da0, nDeriv);
         }
         if (flag) return flag;
 
         // g0;
         if (material_props->step_num[1] == 0) {
-            calCoeffs_nostep(material_props->g0Coefs, g0, dg0, d2g0, sigma);
+            calCoeffs_nostep(material_props->g0Coefs, g0, dg0, sigma, nDeriv);
         }
         else {
-            flag = calCoeffs_step(material_props->step_num[1], sigma, 
-                material_props->g0stress_lim,
-                material_props->g0Coefs, g0, dg0, d2g0);
+            flag = calCoeffs_step(stepIndex[1], hint[1], sigma,
+                material_props->g0Coefs, g0, dg0, nDeriv);
         }
         if (flag) return flag;
 
         // g1;
         if (material_props->step_num[2] == 0) {
-            calCoeffs_nostep(material_props->g1Coefs, g1, dg1, d2g1, sigma);
+            calCoeffs_nostep(material_props->g1Coefs, g1, dg1, sigma, nDeriv);
         }
         else {
-            flag = calCoeffs_step(material_props->step_num[2], sigma, 
-                material_props->g1stress_lim,
-                material_props->g1Coefs, g1, dg1, d2g1);
+            flag = calCoeffs_step(stepIndex[2], hint[2], sigma,
+                material_props->g1Coefs, g1, dg1, nDeriv);
         }
         if (flag) return flag;
 
         // g2;
         if (material_props->step_num[3] == 0) {
-            calCoeffs_nostep(material_props->g2Coefs, g2, dg2, d2g2, sigma);
+            calCoeffs_nostep(material_props->g2Coefs, g2, dg2, sigma, nDeriv);
         }
         else {
-            flag = calCoeffs_step(material_props->step_num[3], sigma, 
-                material_props->g2stress_lim,
-                material_props->g2Coefs, g2, dg2, d2g2);
+            flag = calCoeffs_step(stepIndex[3], hint[3], sigma,
+                material_props->g2Coefs, g2, dg2, nDeriv);
         }
         if (flag) return flag;
 
         // Ep;
         if (material_props->step_num[4] == 0) {
-            calCoeffs_nostep(material_props->EpCoefs, Ep, dEp, d2Ep, sigma);
+            calCoeffs_nostep(material_props->EpCoefs, Ep, dEp, sigma, nDeriv);
         }
         else {
-            flag = calCoeffs_step(material_props->step_num[4], sigma, 
-                material_props->Epstress_lim,
-                material_props->EpCoefs, Ep, dEp, d2Ep);
+            flag = calCoeffs_step(stepIndex[4], hint[4], sigma,
+                material_props->EpCoefs, Ep, dEp, nDeriv);
         }
         if (flag) return flag;
 
         // np;
         if (material_props->step_num[5] == 0) {
-            calCoeffs_nostep(material_props->npCoefs, np, dnp, d2np, sigma);
+            calCoeffs_nostep(material_props->npCoefs, np, dnp, sigma, nDeriv);
         }
         else {
-            flag = calCoeffs_step(material_props->step_num[5], sigma, 
-                material_props->npstress_lim,
-                material_props->npCoefs, np, dnp, d2np);
+            flag = calCoeffs_step(stepIndex[5], hint[5], sigma,
+                material_props->npCoefs, np, dnp, nDeriv);
         }
         if (flag) return flag;
 
         // H_vp;
         if (material_props->step_num[6] == 0) {
-            calCoeffs_nostep(material_props->H_vpCoefs, H_vp, dH_vp, d2H_vp, sigma);
+            calCoeffs_nostep(material_props->H_vpCoefs, H_vp, dH_vp, sigma, nDeriv);
         }
         else {
-            flag = calCoeffs_step(material_props->step_num[6], sigma, 
-                material_props->Hstress_lim,
-                material_props->H_vpCoefs, H_vp, dH_vp, d2H_vp);
+            flag = calCoeffs_step(stepIndex[6], hint[6], sigma,
+                material_props->H_vpCoefs, H_vp, dH_vp, nDeriv);
         }
         if (flag) return flag;
 
         /// Calculates dPsy;
         dPsy = 1 / a0 * dt;
-        d2Psy = -pow(a0, -2) * da0 * dt;
-        d3Psy = (2 * pow(a0, -3) * da0 - pow(a0, -2) * d2a0) * da0 * dt;
-
-        /// Calculates dnpm1;
-        dnpm1 = -pow(np, -2) * dnp;
-
-        /// Calculates dEpm1;
-        dEpm1 = -pow(Ep, -2) * dEp;
         return 0;
     }
 
     ///////////////////////////////////////////////////////////////////////////////
-    /// Calculates function's derivatives for Newton-Raphson method;
+    /// Calculates the Atemp and Btemp terms of the Visco-Elastic function for the
+    /// given dPsy and coefficients, with their derivatives WRT sigma;
     ///////////////////////////////////////////////////////////////////////////////
-    void stressSolver::calDFunc(int mode, int nodeNum, double dt, double te, 
-                                    double sigma, double sigmaim1, double g2im1) {
+    void stressSolver::calAB(int nodeNum, const Dual& Psy, const Dual& g0_in, const Dual& g1_in,
+        const Dual& g2_in, double sigmaim1, double g2im1, Dual& A, Dual& B) {
 
         // Prepares summation terms for construction of Visco-Elastic function;
-        sumDn1 = sumDn2 = sumDn3 = sumDn4 = Exp3 = dExp3 = 0;
-        Atemp = Btemp = dAtemp = dBtemp = dCtemp = DFunc = 0;
+        Dual sum1 = 0.0, sum2 = 0.0;
         for (size_t i = 0; i < material_props->lamdaN.size(); i++) {
+            Dual expN = exp(-material_props->lamdaN[i] * Psy);
+
             // SumDn1
-            sumDn1 += material_props->Dn[i] *
-                exp(-material_props->lamdaN[i] * dPsy) * qnim1[nodeNum][i];
-            
+            sum1 = sum1 + material_props->Dn[i] * expN * qnim1[nodeNum][i];
+
             // SumDn2
-            sumDn2 += (material_props->Dn[i] *
-                (1 - exp(-material_props->lamdaN[i] * dPsy)) /
-                (material_props->lamdaN[i] * dPsy));
+            sum2 = sum2 + (material_props->Dn[i] * (1 - expN) /
+                (material_props->lamdaN[i] * Psy));
+        }
 
-            // SumDn3
-            dExp1 = -material_props->lamdaN[i] * d2Psy * 
-                    exp(-material_props->lamdaN[i] * dPsy);
-            sumDn3 += material_props->Dn[i] * dExp1 * qnim1[nodeNum][i];
+        A = g0_in * material_props->Do + g1_in * g2_in *
+            material_props->sumDn - g1_in * g2_in * sum2;
 
-            // SumDn4
-            dExp2 = d2Psy * exp(-material_props->lamdaN[i] * dPsy) / dPsy +
-                (1 - exp(-material_props->lamdaN[i] * dPsy)) /
-                material_props->lamdaN[i] / dt * da0;
-            sumDn4 += material_props->Dn[i] * dExp2;
-        }
-       
-        // Calculates temporary Atemp and Btemp terms;
-        Atemp = g0 * material_props->Do + g1 * g2 *
-            material_props->sumDn - g1 * g2 * sumDn2;
+        B = g1_in * sum1 - g1_in * g2im1 * sigmaim1 * sum2;
+    }
 
-        Btemp = g1 * sumDn1 - g1 * g2im1 * sigmaim1 * sumDn2;
-        
-        dAtemp = material_props->Do * dg0 + (dg1 * g2 + g1 * dg2) * material_props->sumDn - 
-                    (dg1 * g2 * sumDn2 + g1 * dg2 * sumDn2 + g1 * g2 * sumDn4);
+    ///////////////////////////////////////////////////////////////////////////////
+    /// Calculates function's derivatives for Newton-Raphson method;
+    /// The derivative of Func = eps - A - B - C WRT sigma is obtained by forward-mode
+    /// differentiation of the same expressions (see SC_dualNumber.h);
+    ///////////////////////////////////////////////////////////////////////////////
+    void stressSolver::calDFunc(int mode, int nodeNum, double dt, double te, 
+                                    double sigma, double sigmaim1, double g2im1) {
 
-        dBtemp = g1 * (sumDn3 - g2im1 * sigmaim1 * sumDn4) + 
-                    dg1 * (sumDn1 - g2im1 * sigmaim1 * sumDn2);
+        Dual s(sigma, 1), A, B;
 
-        // Prepares summation terms for Visco-Plastic function;
-        Exp3 = exp(-H_vp / np * te);
-        dExp3 = -te * (dH_vp / np + H_vp * dnpm1) * Exp3;
+        // Visco-Elastic terms;
+        calAB(nodeNum, 1 / Dual(a0, da0) * dt, Dual(g0, dg0), Dual(g1, dg1), Dual(g2, dg2),
+            sigmaim1, g2im1, A, B);
+        Dual F = -A * s + B;
 
-        // Calculates dCd term(Visco-Plastic model);
+        // Visco-Plastic term;
         if (mode != 0) {
-            if (te == dt) {
-                dCtemp = 1 / Ep + sigma * dEpm1 + 
-                            dt * (1 / np * Exp3 + sigma * 
-                                    dnpm1 * Exp3 + sigma * 1 / np * dExp3) - 
-                            dt * material_props->sigma_yield0 * 
-                            (dnpm1 * Exp3 + 1 / np * dExp3);
-            }
-            else {
-                dCtemp = dt * (1 / np * Exp3 + sigma * 
-                            dnpm1 * Exp3 + sigma * 1 / np * dExp3) -
-                         dt * material_props->sigma_yield0 * 
-                         (dnpm1 * Exp3 + 1 / np * dExp3);
-            }
+            Dual npd(np, dnp);
+            Dual C = dt * (s - material_props->sigma_yield0) / npd * 
+                        exp(-Dual(H_vp, dH_vp) / npd * te);
+            if (te == dt)
+                C = C + s / Dual(Ep, dEp);
+            F = F - C;
         }
-        else {
-            dCtemp = 0;
-        }
-        
-        // Calculates DFunc with func = eps - A - B - C;
-            DFunc = -Atemp - dAtemp * sigma + dBtemp - dCtemp;
+
+        Atemp = A.v; Btemp = B.v;
+        DFunc = F.d;
 
     } // End of calDFunc
 
@@ -329,37 +312,10 @@ namespace rope {
     double stressSolver::calStiff(double sigma) {
 
         g0 = 0;
-        vector<vector<double>> stress_lim = material_props->g0stress_lim;
-        if (material_props->step_num[1] == 0) {
-            calCoeffs_nostep(material_props->g0Coefs, g0, dg0, d2g0, sigma);
-            for (int i = 0; i < material_props->g0Coefs.size(); i++) {
-                g0 += material_props->g0Coefs[i] * pow(sigma, i);
-            }
-        }
-        else {
-            for (int i = 0; i < material_props->step_num[1]; i++) {
-                if (i == 0 && sigma <= stress_lim[0][i]) {
-                    for (int j = 0; j < stress_lim[1][i]; j++) {
-                        g0 += material_props->g0Coefs[j] * pow(sigma, j);
-                    }
-                    break; // Success
-                }
-                else if (i == (material_props->step_num[1] - 1) && sigma > stress_lim[0][i]) {
-                    for (int j = stress_lim[1][i]; j < material_props->g0Coefs.size(); j++) {
-                        jtemp = j - stress_lim[1][i];
-                        g0 += material_props->g0Coefs[j] * pow(sigma, jtemp);
-                    }
-                    break; // Success
-                }
-                else if (sigma > stress_lim[0][i] && sigma <= stress_lim[0][i + 1]) {
-                    for (int j = stress_lim[1][i]; j < stress_lim[1][i + 1]; j++) {
-                        jtemp = j - stress_lim[1][i];
-                        g0 += material_props->g0Coefs[j] * pow(sigma, jtemp);
-                    }
-                    break; // Success
-                }
-            }
-        }       
+        if (material_props->step_num[1] == 0)
+            calCoeffs_nostep(material_props->g0Coefs, g0, dg0, sigma, 0);
+        else
+            calCoeffs_step(stepIndex[1], stiff_hint, sigma, material_props->g0Coefs, g0, dg0, 0);
         double E = 1/(g0 * material_props->Do)*material_props->MBL;
         return E;
 
@@ -373,6 +329,7 @@ namespace rope {
         /////////////////////////////////////////////////////////////////////
         /// VISCO-ELASTIC MODEL ONLY;
         ////////////////////////////////////////////////////////////////////
+        DFunc = 0;
         if (dataIn == 0) {
             eps_vp = eps_vp;
             stemp_new = 0;
@@ -389,7 +346,7 @@ namespace rope {
                 while (abs(err) >= material_props->tol && iter < material_props->limit) {
 
                     /// Calculates instantaneous value for each coefficient;
-                    flag = calCoeffs(stemp, dt);
+                    flag = calCoeffs(stemp, dt, 1, &step_hint[7 * nodeNum]);
                     if (flag)
                         return ErrorCode::NON_LOGICAL_COEFFICIENT_INPUT;
 
@@ -430,6 +387,7 @@ namespace rope {
                 eps_Vtemp[nodeNum] = dataIn;
                 g2_Vtemp[nodeNum] = g2;
                 dPsy_Vtemp[nodeNum] = dPsy;
+                stiff_Vtemp[nodeNum] = (DFunc < 0) ? -1 / DFunc : 1 / (g0 * material_props->Do);
                 return ErrorCode::SUCCESS;
             }
             else 
@@ -437,6 +395,32 @@ namespace rope {
         }
     }
 
+    ///////////////////////////////////////////////////////////////////////////////
+    /// Initial stress guess of the visco-elastic Newton solve;
+    ///////////////////////////////////////////////////////////////////////////////
+    double stressSolver::predict(int nodeNum, double dataIn) {
+
+        // Tangent predictor: latest solution of the node plus the strain increment times its
+        // tangent stiffness. Mode 2 extrapolates the committed stresses in time and corrects
+        // the extrapolation with the tangent for the change of the strain increment;
+        if (material_props->predictor > 0 && stiff_Vtemp[nodeNum] > 0) {
+            double spred;
+            if (material_props->predictor == 1)
+                spred = sigma_Vtemp[nodeNum] + stiff_Vtemp[nodeNum] * (dataIn - eps_Vtemp[nodeNum]);
+            else
+                spred = 2 * sigmaim1[nodeNum] - sigmaim2[nodeNum] + stiff_Vtemp[nodeNum] *
+                    ((dataIn - epsim1[nodeNum]) - (epsim1[nodeNum] - epsim2[nodeNum]));
+            if (spred > 0 && !isnan(spred))
+                return spred;
+        }
+
+        // Predicts little change in stresses;
+        if (abs(sigmaim1[nodeNum] - sigmaim2[nodeNum]) < material_props->tol)
+            return sigmaim1[nodeNum];
+        else
+            return 2 * sigmaim1[nodeNum] - sigmaim2[nodeNum];
+    }
+
     ///////////////////////////////////////////////////////////////////////////////
     /// SYNCOM - Module 2: Evaluates time history of material behaviors. 
     /// Input: time history of strain (deformation). Output: applying stress.
@@ -452,9 +436,33 @@ namespace rope {
         else if (dataIn < 0)
             return ErrorCode::NEGATIVE_STRAIN_DETECTED;
 
+        DFunc = 0; nIter = 0; reused = 0;
+
+        // Quiescent node: the stress is extrapolated from the last full evaluation with its
+        // tangent stiffness. g2 and dPsy are taken from that evaluation, so that updateParams
+        // still decays the Prony states (calQn) as for a full solve;
+        if (skip_tol > 0 && skip_count[nodeNum] >= 0 && skip_count[nodeNum] < skip_max && te[nodeNum] == 0
+            && abs(dataIn - skip_eps[nodeNum]) <= skip_tol && abs(dt - skip_dt[nodeNum]) <= 1e-9 * dt) {
+            double s = skip_sigma[nodeNum] + skip_stiff[nodeNum] * (dataIn - skip_eps[nodeNum]);
+            if (s > 0 && s < sigma_yield[nodeNum]) {
+                stress_SC = s;
+                sigma_Vtemp[nodeNum] = s;
+                eps_Vtemp[nodeNum] = dataIn;
+                g2_Vtemp[nodeNum] = skip_g2[nodeNum];
+                dPsy_Vtemp[nodeNum] = skip_dPsy[nodeNum];
+                eps_vp_Vtemp[nodeNum] = eps_vp[nodeNum];
+                stiff_Vtemp[nodeNum] = skip_stiff[nodeNum];
+                skip_count[nodeNum]++;
+                reused = 1;
+                return ErrorCode::SUCCESS;
+            }
+        }
+        skip_count[nodeNum] = -1;
+        int cacheable = 0;
+
         if (dataIn <= material_props->tol) {
             stemp_new = 0;
-            calCoeffs(stemp_new, dt);
+            calCoeffs(stemp_new, dt, 0, &step_hint[7 * nodeNum]);
             eps_vp_Vtemp[nodeNum] = eps_vp[nodeNum];
         }
         else {
@@ -462,17 +470,13 @@ namespace rope {
                 err = 1; iter = 1; mode = 0;
               
                 // Guesses initial value of stress;
-                // Predicts little change in stresses;
-                if (abs(sigmaim1[nodeNum] - sigmaim2[nodeNum]) < material_props->tol)
-                    stemp = sigmaim1[nodeNum];
-                else
-                    stemp = (2 * sigmaim1[nodeNum] - sigmaim2[nodeNum]);
+                stemp = predict(nodeNum, dataIn);
 
                 // Solve for stress iteratively using Visco-Elastic model only;
                 while (abs(err) >= material_props->tol && iter < material_props->limit) {
 
                     /// Calculates instantaneous value for each coefficient;
-                    flag = calCoeffs(stemp, dt);
+                    flag = calCoeffs(stemp, dt, 1, &step_hint[7 * nodeNum]);
                     if (flag)
                         return ErrorCode::NON_LOGICAL_COEFFICIENT_INPUT;
 
@@ -498,8 +502,9 @@ namespace rope {
                         err = 0; iter = 1;
                     }
 
-                    iter = iter + 1; 
+                    iter = iter + 1; nIter++;
                 } 
+                cacheable = 1;
             }
             else {
                 stemp_new = sigmaim1[nodeNum];
@@ -514,7 +519,7 @@ namespace rope {
                 && (dataIn - epsim1[nodeNum]) >= material_props->tol) {
                 cout << dt << "     " << epsim1[nodeNum] << "     " << dataIn << "     " << DFunc << "    " << "Enter Viscoplastic Solver" << endl;
                 // Resets conditional variables;
-                err = 1; iter = 1; mode = 1; int iter2 = 1;
+                err = 1; iter = 1; mode = 1; int iter2 = 1; cacheable = 0;
                 te_Vtemp[nodeNum] = te[nodeNum] + dt;
 
                 // Guesses initial value of stress;
@@ -527,7 +532,7 @@ namespace rope {
                 while (abs(err) >= material_props->tol && iter < material_props->limit) {
 
                     /// Calculates instantaneous value for each coefficient;
-                    flag = calCoeffs(stemp, dt);
+                    flag = calCoeffs(stemp, dt, 1, &step_hint[7 * nodeNum]);
                     if (flag)
                         return ErrorCode::NON_LOGICAL_COEFFICIENT_INPUT;
 
@@ -557,7 +562,7 @@ namespace rope {
                     else
                         stemp = stemp_new;
 
-                    iter = iter + 1;
+                    iter = iter + 1; nIter++;
 
                 }
          
@@ -584,6 +589,20 @@ namespace rope {
             eps_Vtemp[nodeNum] = dataIn;
             g2_Vtemp[nodeNum] = g2;
             dPsy_Vtemp[nodeNum] = dPsy;
+
+            // Tangent stiffness dsigma/deps = -1/DFunc (falls back on the instantaneous stiffness);
+            stiff_Vtemp[nodeNum] = (DFunc < 0) ? -1 / DFunc : 1 / (g0 * material_props->Do);
+
+            // Keeps visco-elastic solutions for reuse on quiescent nodes;
+            if (skip_tol > 0 && cacheable) {
+                skip_eps[nodeNum] = dataIn;
+                skip_dt[nodeNum] = dt;
+                skip_sigma[nodeNum] = stemp_new;
+                skip_stiff[nodeNum] = stiff_Vtemp[nodeNum];
+                skip_g2[nodeNum] = g2;
+                skip_dPsy[nodeNum] = dPsy;
+                skip_count[nodeNum] = 0;
+            }
         }
         else
             return ErrorCode::NO_CONVERGED_SOLUTION;
@@ -621,6 +640,7 @@ namespace rope {
             calQn(nodeNum, sigma_cal[nodeNum], sigmaim1[nodeNum], g2_Vtemp[nodeNum], g2im1[nodeNum], dPsy_Vtemp[nodeNum]);  // updates qnim1
             sigmaim2[nodeNum] = sigmaim1[nodeNum];
             sigmaim1[nodeNum] = sigma_cal[nodeNum];
+            epsim2[nodeNum] = epsim1[nodeNum];
             epsim1[nodeNum] = eps_Vtemp[nodeNum];
             g2im1[nodeNum] = g2_Vtemp[nodeNum];
         }
@@ -630,6 +650,142 @@ namespace rope {
 
     } // End of updateParams
 
+    ///////////////////////////////////////////////////////////////////////////////
+    /// Writes/reads one nodal vector (size followed by the values);
+    //////////////////////////////////////////////////////////////////////////////
+    static void writeVec(std::ostream& out, const std::vector<double>& v) {
+        int n = (int)v.size();
+        out.write((const char*)&n, sizeof(n));
+        if (n > 0) out.write((const char*)&v[0], n * sizeof(double));
+    }
+
+    static int readVec(std::istream& in, std::vector<double>& v) {
+        int n = 0;
+        in.read((char*)&n, sizeof(n));
+        if (!in || n != (int)v.size())
+            return 1;
+        if (n > 0) in.read((char*)&v[0], n * sizeof(double));
+        return in ? 0 : 1;
+    }
+
+    static int skipVec(std::istream& in, const std::vector<double>& v) {
+        int n = 0;
+        in.read((char*)&n, sizeof(n));
+        if (!in || n != (int)v.size())
+            return 1;
+        in.ignore(n * sizeof(double));
+        return in ? 0 : 1;
+    }
+
+    static size_t vecSize(const std::vector<double>& v) {
+        return sizeof(int) + v.size() * sizeof(double);
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////
+    /// Saves the nodal history of the solver (binary);
+    //////////////////////////////////////////////////////////////////////////////
+    void stressSolver::saveState(std::ostream& out) {
+
+        writeVec(out, te);
+        writeVec(out, epsim1);
+        writeVec(out, epsim2);
+        writeVec(out, sigmaim1);
+        writeVec(out, sigmaim2);
+        writeVec(out, g2im1);
+        writeVec(out, sigma_yield);
+        writeVec(out, eps_vp);
+        writeVec(out, sigma_cal);
+        for (size_t i = 0; i < qnim1.size(); i++)
+            writeVec(out, qnim1[i]);
+
+        writeVec(out, te_Vtemp);
+        writeVec(out, sigma_Vtemp);
+        writeVec(out, eps_vp_Vtemp);
+        writeVec(out, eps_Vtemp);
+        writeVec(out, g2_Vtemp);
+        writeVec(out, dPsy_Vtemp);
+        writeVec(out, stiff_Vtemp);
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////
+    /// Restores the nodal history written by saveState. The solver has to be
+    /// initialized with the same number of nodes. Returns 0 on success;
+    //////////////////////////////////////////////////////////////////////////////
+    int stressSolver::loadState(std::istream& in) {
+
+        int err = 0;
+        err += readVec(in, te);
+        err += readVec(in, epsim1);
+        err += readVec(in, epsim2);
+        err += readVec(in, sigmaim1);
+        err += readVec(in, sigmaim2);
+        err += readVec(in, g2im1);
+        err += readVec(in, sigma_yield);
+        err += readVec(in, eps_vp);
+        err += readVec(in, sigma_cal);
+        for (size_t i = 0; i < qnim1.size(); i++)
+            err += readVec(in, qnim1[i]);
+
+        err += readVec(in, te_Vtemp);
+        err += readVec(in, sigma_Vtemp);
+        err += readVec(in, eps_vp_Vtemp);
+        err += readVec(in, eps_Vtemp);
+        err += readVec(in, g2_Vtemp);
+        err += readVec(in, dPsy_Vtemp);
+        err += readVec(in, stiff_Vtemp);
+
+        // The reused evaluations are not part of the history; the next call solves every node;
+        std::fill(skip_count.begin(), skip_count.end(), -1);
+
+        return err ? 1 : 0;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////
+    /// Checks a history written by saveState against the solver without loading
+    /// it (same layout as loadState). Returns 0 if loadState would succeed;
+    //////////////////////////////////////////////////////////////////////////////
+    int stressSolver::checkState(std::istream& in) {
+
+        int err = 0;
+        err += skipVec(in, te);
+        err += skipVec(in, epsim1);
+        err += skipVec(in, epsim2);
+        err += skipVec(in, sigmaim1);
+        err += skipVec(in, sigmaim2);
+        err += skipVec(in, g2im1);
+        err += skipVec(in, sigma_yield);
+        err += skipVec(in, eps_vp);
+        err += skipVec(in, sigma_cal);
+        for (size_t i = 0; i < qnim1.size(); i++)
+            err += skipVec(in, qnim1[i]);
+
+        err += skipVec(in, te_Vtemp);
+        err += skipVec(in, sigma_Vtemp);
+        err += skipVec(in, eps_vp_Vtemp);
+        err += skipVec(in, eps_Vtemp);
+        err += skipVec(in, g2_Vtemp);
+        err += skipVec(in, dPsy_Vtemp);
+        err += skipVec(in, stiff_Vtemp);
+
+        return err ? 1 : 0;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////
+    /// Number of bytes written by saveState;
+    //////////////////////////////////////////////////////////////////////////////
+    size_t stressSolver::stateSize() {
+
+        size_t n = vecSize(te) + vecSize(epsim1) + vecSize(epsim2) + vecSize(sigmaim1)
+            + vecSize(sigmaim2) + vecSize(g2im1) + vecSize(sigma_yield) + vecSize(eps_vp)
+            + vecSize(sigma_cal);
+        for (size_t i = 0; i < qnim1.size(); i++)
+            n += vecSize(qnim1[i]);
+
+        n += vecSize(te_Vtemp) + vecSize(sigma_Vtemp) + vecSize(eps_vp_Vtemp) + vecSize(eps_Vtemp)
+            + vecSize(g2_Vtemp) + vecSize(dPsy_Vtemp) + vecSize(stiff_Vtemp);
+        return n;
+    }
+
 } // End of namespace rope.
 
 
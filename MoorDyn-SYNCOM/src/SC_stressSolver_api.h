@@ -20,15 +20,53 @@
 #define SC_stressSolver_api_h
 
 #include "SC_error.h"
+#include "SC_dualNumber.h"
 #include <math.h>
 #include <iostream>
 #include <vector>
+#include <algorithm>
 #include <sstream>
 
 using namespace std;
 
 namespace rope {
 
+    ///////////////////////////////////////////////////////////////////////////////
+    /// Index of a material parameter defined with step functions: the stress
+    /// limits L(...) in a flat ascending array and the first coefficient of each
+    /// piece. Piece k holds lim[k - 1] < sigma <= lim[k] (piece 0: sigma <= lim[0],
+    /// last piece: sigma > lim[n - 1]);
+    ///////////////////////////////////////////////////////////////////////////////
+    struct StepIndex
+    {
+        std::vector<double> lim;    // stress limits;
+        std::vector<int> first;     // first coefficient of each piece, then the number of coefficients;
+
+        void build(const std::vector<std::vector<double>>& stress_lim, int step_num, size_t nCoefs) {
+            lim.clear();
+            first.assign(1, 0);
+            for (int i = 0; i < step_num; i++) {
+                lim.push_back(stress_lim[0][i]);
+                first.push_back((int)stress_lim[1][i]);
+            }
+            first.push_back((int)nCoefs);
+        }
+
+        /// Returns the piece holding sigma (-1 for NaN). hint is the piece found by the
+        /// previous call; it is checked first since sigma rarely changes piece between
+        /// Newton iterations, otherwise the limits are binary searched;
+        int find(double sigma, int& hint) const {
+            int n = (int)lim.size();
+            if (hint >= 0 && hint <= n && (hint == 0 || lim[hint - 1] < sigma)
+                && (hint == n || sigma <= lim[hint]))
+                return hint;
+            if (isnan(sigma))
+                return -1;
+            hint = (int)(std::lower_bound(lim.begin(), lim.end(), sigma) - lim.begin());
+            return hint;
+        }
+    };
+
     struct MatProps
     {
         /// Material properties 
@@ -61,6 +99,7 @@ namespace rope {
         /// Module selection, time and Stress/Strain input data;
         double tol;
         int limit;
+        int predictor;
     };
 
     class stressSolver {
@@ -69,6 +108,7 @@ namespace rope {
         // Nodal properties;
         std::vector<double> te;
         std::vector<double> epsim1;
+        std::vector<double> epsim2;
         std::vector<double> sigmaim1;
         std::vector<double> sigmaim2;
         std::vector<double> g2im1;
@@ -86,33 +126,53 @@ namespace rope {
         std::vector<double> eps_Vtemp;
         std::vector<double> g2_Vtemp;
         std::vector<double> dPsy_Vtemp;
+        std::vector<double> stiff_Vtemp;    // tangent stiffness of the last solution (normalized);
+
+        // Quiescent node skipping: last full visco-elastic evaluation of each node;
+        double skip_tol;                    // strain tolerance for reusing an evaluation (0 = off);
+        int skip_max;                       // max number of consecutive reuses before a full evaluation;
+        std::vector<double> skip_eps;
+        std::vector<double> skip_dt;
+        std::vector<double> skip_sigma;
+        std::vector<double> skip_stiff;
+        std::vector<double> skip_g2;
+        std::vector<double> skip_dPsy;
+        std::vector<int> skip_count;        // reuses since the evaluation (-1 = no valid evaluation);
+
+        // Step functions: index of each material parameter (a0, g0, g1, g2, Ep, np, H)
+        // and the piece last found for each node (7 per node);
+        StepIndex stepIndex[7];
+        std::vector<int> step_hint;
+        int stiff_hint;                     // piece last found by calStiff;
 
         // Temporary variables;
         int mode, iter;
+        int nIter;      // Newton iterations of the last syncom_solver call (both models);
+        int reused;     // 1 if the last syncom_solver call reused a cached evaluation;
 
         double a0, g0, g1, g2, Ep, np, H_vp,
-            da0, dg0, dg1, dg2, dEp, dEpm1,  // 1st derivative WRT sigma (applied stress)
-            dnp, dnpm1, dH_vp, d2a0, d2g0,   // 2nd derivative WRT sigma (applied stress)
-            d2g1, d2g2, d2Ep, d2np, d2H_vp,
-            dPsy, d2Psy, d3Psy, Func, DFunc;
+            da0, dg0, dg1, dg2, dEp,         // 1st derivative WRT sigma (applied stress)
+            dnp, dH_vp,
+            dPsy, Func, DFunc;
 
         int flag; 
 
-        double jtemp, err, stemp, stemp_new, sumDn1, sumDn2, sumDn3, 
-               sumDn4, Exp3, Atemp, Btemp, dAtemp, dBtemp, 
-               dCtemp, dExp1, dExp2, dExp3, eps_vp_temp;
+        double err, stemp, stemp_new, Atemp, Btemp, eps_vp_temp;
 
         // Functions;
-        int calCoeffs(double sigma, double dt);
-        int calCoeffs_step(int step_num, double sigma, 
-            std::vector<std::vector<double>>& stress_lim, 
-            std::vector<double>& xyzCoefs,
-            double& xyz, double& dxyz, double& d2xyz);
+        int calCoeffs(double sigma, double dt, int nDeriv, int* hint);
+        void calPoly(std::vector<double>& xyzCoefs, int begin, int end,
+            double sigma, double& xyz, double& dxyz, int nDeriv);
+        int calCoeffs_step(const StepIndex& steps, int& hint, double sigma,
+            std::vector<double>& xyzCoefs, double& xyz, double& dxyz, int nDeriv);
         void calCoeffs_nostep(std::vector<double>& xyzCoefs, double& xyz,
-            double& dxyz, double& d2xyz, double sigma);
+            double& dxyz, double sigma, int nDeriv);
+        void calAB(int nodeNum, const Dual& Psy, const Dual& g0_in, const Dual& g1_in,
+            const Dual& g2_in, double sigmaim1, double g2im1, Dual& A, Dual& B);
         void calDFunc(int mode, int nodeNum, double dt, double te,
                             double sigma, double sigmaim1, double g2im1);
         void calQn(int nodeNum, double sigma, double sigmaim1, double g2, double g2im1, double dPsy);
+        double predict(int nodeNum, double dataIn);
 
     public:
         stressSolver(MatProps* mat_props);
@@ -129,6 +189,17 @@ namespace rope {
         double get_sigmaim1(int nodeNum) { return sigmaim1[nodeNum]; };
         double get_eps_vp(int nodeNum) { return eps_vp[nodeNum]; };
         double get_eps(int nodeNum) { return eps_Vtemp[nodeNum]; };
+        double get_epsim1(int nodeNum) { return epsim1[nodeNum]; };
+        double get_stiff(int nodeNum) { return stiff_Vtemp[nodeNum] * material_props->MBL; };
+        int get_nIter(void) { return nIter; };
+        int get_reused(void) { return reused; };
+        void set_skip(double tol, int maxReuse);
+
+        /// Binary save/restore of the nodal history (IC cache, checkpoints);
+        void saveState(std::ostream& out);
+        int loadState(std::istream& in);
+        int checkState(std::istream& in);
+        size_t stateSize();
 
         /// Important: The MaterDef.xml should be in the same folder
         std::string sc_inputfile;
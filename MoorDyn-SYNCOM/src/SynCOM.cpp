@@ -32,7 +32,7 @@ namespace rope {
         ErrorOut errorOut;
         std::string filename(input_file);
         stressSolver.sc_folder = filename.substr(0, filename.find_last_of("/\\") + 1);
-        stressSolver.sc_inputfile = filename;
+        stressSolver.sc_inputfile = filename.substr(filename.find_last_of("/\\") + 1);
         
         /// Print info and read inputs;
         errCodes = readInput.readIn_data(line_type, stressSolver);
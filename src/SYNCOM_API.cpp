@@ -23,10 +23,13 @@
 #include "strainSolver_api.h"
 #include "stressSolver_api.h"
 #include "printOut_api.h"
-#include "SynCOM_API.h"
+#include "SYNCOM_API.h"
 #include <chrono>
 #include <string>
 #include <iostream>
+#include <vector>
+#include <algorithm>
+#include <thread>
 
 using namespace std;
 using namespace std::chrono;
@@ -166,4 +169,448 @@ double DECLDIR extract_sigma(void)
         return stressOutput.get_sigma();
 }
 
+/// Newton iterations;
+int DECLDIR extract_nIter(void)
+{
+    if (setting.module == 0)
+        return 0;
+    else
+        return stressOutput.get_nIter();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Cycle jumping.
+////////////////////////////////////////////////////////////////////////////////
+/// Runs one loading cycle;
+template<class Solver>
+static rope::ErrorCode run_cycle(Solver& solver, double dataIn[], double dt[], int nSteps)
+{
+    for (int j = 0; j < nSteps; j++) {
+        rope::ErrorCode err = solver.syncom_solver(setting, dataIn[j], dt[j]);
+        if (err != rope::ErrorCode::SUCCESS)
+            return err;
+    }
+    return rope::ErrorCode::SUCCESS;
+}
+
+/// Cycle-to-cycle ratio of each slow state increment (clipped to [0, 1]: 1 for a
+/// steady drift, below 1 for a decaying transient, 0 for an oscillating component);
+static void cycle_ratio(const vector<double>& inc, const vector<double>& incPrev,
+    vector<double>& r)
+{
+    r.resize(inc.size());
+    for (size_t i = 0; i < inc.size(); i++)
+        r[i] = (incPrev[i] != 0) ? min(max(inc[i] / incPrev[i], 0.0), 1.0) : 1.0;
+}
+
+/// Change of the slow state over the next n cycles when each increment keeps
+/// decreasing geometrically by r (linear drift for r = 1);
+static double cycle_sum(double inc, double r, int n)
+{
+    return (r >= 1) ? n * inc : inc * r * (1 - pow(r, n)) / (1 - r);
+}
+
+/// Largest deviation between the simulated and predicted increments of the
+/// slow state, relative to the state (absolute below atol);
+static double cycle_deviation(const vector<double>& inc, const vector<double>& pred,
+    const vector<double>& y, double atol)
+{
+    double dev = 0;
+    for (size_t i = 0; i < y.size(); i++)
+        dev = max(dev, abs(inc[i] - pred[i]) / max(abs(y[i]), atol));
+    return dev;
+}
+
+/// Repeats the cycle nCycles times. When the cycle-to-cycle increments of the
+/// slow state follow a steady ratio (an increment is predicted from the two
+/// before within tol), the state is extrapolated over the next nJump cycles
+/// and one control cycle is simulated. The jump is kept if the control cycle
+/// reproduces the predicted increment (nJump times its deviation within tol)
+/// and the jump length is doubled; otherwise the state is restored, the jump
+/// length halved and the drift detection restarted. Cycle c is read from
+/// dataIn/dt + c * stride (stride 0: the same cycle every time);
+template<class Solver>
+static rope::ErrorCode run_cycles(Solver& solver, double dataIn[], double dt[], int nSteps,
+    int nCycles, double tol, int& nSimulated, int stride = 0)
+{
+    double period = 0;
+    for (int j = 0; j < nSteps; j++)
+        period += dt[j];
+
+    vector<double> y0, y1, yJ, inc, incPrev, r, pred;
+    int nDone = 0, jump = 1;
+    nSimulated = 0;
+
+    solver.get_slowState(y0);
+    while (nDone < nCycles) {
+
+        // Simulates one cycle;
+        rope::ErrorCode err = run_cycle(solver, dataIn + nDone * stride, dt + nDone * stride, nSteps);
+        if (err != rope::ErrorCode::SUCCESS)
+            return err;
+        nDone++; nSimulated++;
+
+        solver.get_slowState(y1);
+        inc.resize(y1.size());
+        pred.resize(y1.size());
+        for (size_t i = 0; i < y1.size(); i++)
+            inc[i] = y1[i] - y0[i];
+
+        // Checks the increment against the one predicted by the previous ratio;
+        bool steady = false;
+        if (!incPrev.empty()) {
+            if (!r.empty()) {
+                for (size_t i = 0; i < y1.size(); i++)
+                    pred[i] = incPrev[i] * r[i];
+                steady = cycle_deviation(inc, pred, y1, setting.tol) <= tol;
+            }
+            cycle_ratio(inc, incPrev, r);
+        }
+
+        // Jumps (one cycle is left for control);
+        int nJump = min(jump, nCycles - nDone - 1);
+        if (steady && nJump > 0) {
+
+            Solver saved = solver;
+            yJ.resize(y1.size());
+            for (size_t i = 0; i < y1.size(); i++) {
+                yJ[i] = y1[i] + cycle_sum(inc[i], r[i], nJump);
+                pred[i] = inc[i] * pow(r[i], nJump + 1);
+            }
+            solver.set_slowState(yJ, nJump * period);
+
+            // Control cycle;
+            int c = nDone + nJump;
+            err = run_cycle(solver, dataIn + c * stride, dt + c * stride, nSteps);
+            nSimulated++;
+            if (err == rope::ErrorCode::SUCCESS) {
+                solver.get_slowState(y0);
+                for (size_t i = 0; i < y0.size(); i++)
+                    yJ[i] = y0[i] - yJ[i];
+                if (nJump * cycle_deviation(yJ, pred, y0, setting.tol) <= tol) {
+                    nDone += nJump + 1;
+                    jump = 2 * jump;
+                    incPrev = yJ;
+                    continue;
+                }
+            }
+
+            // Rejected: restarts from the state before the jump;
+            solver = saved;
+            jump = max(jump / 2, 1);
+            r.clear();
+        }
+        incPrev = inc;
+        y0 = y1;
+    }
+    return rope::ErrorCode::SUCCESS;
+}
+
+int DECLDIR SynCOM_cycles(double dataIn[], double dt[], int nSteps, int nCycles,
+    double tol, int* nSimulated)
+{
+    int nSim = 0;
+    if (nSteps <= 0 || nCycles <= 0)
+        errCodes = rope::ErrorCode::BAD_CYCLE_INPUT;
+    else if (setting.module == 0)
+        errCodes = run_cycles(strainOutput, dataIn, dt, nSteps, nCycles, tol, nSim);
+    else
+        errCodes = run_cycles(stressOutput, dataIn, dt, nSteps, nCycles, tol, nSim);
+
+    if (nSimulated)
+        *nSimulated = nSim;
+
+    /// Check simulation end status.
+    if (errCodes != rope::ErrorCode::SUCCESS)
+    {
+        print_log(setting, errCodes, errorOut);
+        return 1;
+    }
+
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Time history with cycle jumping.
+////////////////////////////////////////////////////////////////////////////////
+/// True if the n samples at dataIn/dt + P repeat the ones at dataIn/dt (dataIn
+/// within atol, dt within rtol relative);
+static bool cycle_match(const double dataIn[], const double dt[], int n, int P,
+    double atol, double rtol)
+{
+    for (int i = 0; i < n; i++)
+        if (abs(dataIn[P + i] - dataIn[i]) > atol || abs(dt[P + i] - dt[i]) > rtol * dt[i])
+            return false;
+    return true;
+}
+
+/// Detects a loading cycle repeated from the start of the history. The
+/// candidate periods are the later samples crossing the starting level in the
+/// same direction (level within matchTol of the load range of the cycle); the
+/// first one whose cycle is repeated sample by sample by the next one is the
+/// period. Returns the period in samples (0 if there is none up to maxPeriod)
+/// and, in nRep, the number of consecutive cycles matching the first one;
+static int detect_period(const double dataIn[], const double dt[], int nSteps,
+    int maxPeriod, double matchTol, int& nRep)
+{
+    nRep = 0;
+    int nScan = min(nSteps, 2 * maxPeriod);
+    if (nScan < 4)
+        return 0;
+
+    double lo = dataIn[0], hi = dataIn[0];
+    bool rising = dataIn[1] >= dataIn[0];
+    for (int P = 2; 2 * P <= nScan; P++) {
+        lo = min(lo, dataIn[P - 1]);
+        hi = max(hi, dataIn[P - 1]);
+        double atol = matchTol * (hi - lo);
+        if (hi == lo)
+            continue;       // (holds are left to SynCOM_history)
+        if ((dataIn[P + 1] >= dataIn[P]) != rising || abs(dataIn[P] - dataIn[0]) > atol)
+            continue;
+        if (!cycle_match(dataIn, dt, P, P, atol, matchTol))
+            continue;
+
+        // Counts the following cycles that match the first one;
+        nRep = 2;
+        while ((nRep + 1) * P <= nSteps
+            && cycle_match(dataIn, dt, P, nRep * P, atol, matchTol))
+            nRep++;
+        return P;
+    }
+    return 0;
+}
+
+/// Steps through the history; where detect_period finds a repeated cycle, the
+/// cycles are passed to run_cycles (each simulated cycle with its own samples)
+/// and the detection resumes after them. The detection works from any phase of
+/// a cycle, so after a miss it is retried only every maxPeriod / 4 samples;
+template<class Solver>
+static rope::ErrorCode run_periodic(Solver& solver, double dataIn[], double dt[], int nSteps,
+    int maxPeriod, double matchTol, double tol, int& nSimulated)
+{
+    nSimulated = 0;
+    int j = 0;
+    while (j < nSteps) {
+        int nRep, nSim;
+        int P = detect_period(dataIn + j, dt + j, nSteps - j, maxPeriod, matchTol, nRep);
+
+        rope::ErrorCode err;
+        if (P > 0) {
+            err = run_cycles(solver, dataIn + j, dt + j, P, nRep, tol, nSim, P);
+            nSimulated += nSim * P;
+            j += nRep * P;
+        }
+        else {
+            int n = min(max(maxPeriod / 4, 1), nSteps - j);
+            err = run_cycle(solver, dataIn + j, dt + j, n);
+            nSimulated += n;
+            j += n;
+        }
+        if (err != rope::ErrorCode::SUCCESS)
+            return err;
+    }
+    return rope::ErrorCode::SUCCESS;
+}
+
+int DECLDIR SynCOM_periodic(double dataIn[], double dt[], int nSteps, int maxPeriod,
+    double matchTol, double tol, int* nSimulated)
+{
+    int nSim = 0;
+    if (setting.module == 0)
+        errCodes = run_periodic(strainOutput, dataIn, dt, nSteps, maxPeriod, matchTol, tol, nSim);
+    else
+        errCodes = run_periodic(stressOutput, dataIn, dt, nSteps, maxPeriod, matchTol, tol, nSim);
+
+    if (nSimulated)
+        *nSimulated = nSim;
+
+    /// Check simulation end status.
+    if (errCodes != rope::ErrorCode::SUCCESS)
+    {
+        print_log(setting, errCodes, errorOut);
+        return 1;
+    }
+
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Time history with hold fast-forward.
+////////////////////////////////////////////////////////////////////////////////
+int DECLDIR SynCOM_history(double dataIn[], double dt[], int nSteps, double tol,
+    double out[])
+{
+    errCodes = rope::ErrorCode::SUCCESS;
+
+    /// Splits the history into holds (runs of equal dataIn and dt, single
+    /// samples included) and passes each one to the solver;
+    int j = 0;
+    while (j < nSteps && errCodes == rope::ErrorCode::SUCCESS) {
+        int n = 1;
+        while (j + n < nSteps && dataIn[j + n] == dataIn[j] && dt[j + n] == dt[j])
+            n++;
+
+        if (setting.module == 0)
+            errCodes = strainOutput.hold(setting, dataIn[j], dt[j], n, out ? out + j : NULL);
+        else
+            errCodes = stressOutput.hold(setting, dataIn[j], dt[j], n, tol, out ? out + j : NULL);
+        j += n;
+    }
+
+    /// Check simulation end status.
+    if (errCodes != rope::ErrorCode::SUCCESS)
+    {
+        print_log(setting, errCodes, errorOut);
+        return 1;
+    }
+
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// Parallel-in-time (Parareal) solution.
+////////////////////////////////////////////////////////////////////////////////
+/// Output of a sample: strain (module 0) or stress (module 1);
+static double sample_output(rope::strainSolver& solver) { return solver.get_eps(); }
+static double sample_output(rope::stressSolver& solver) { return solver.get_sigma(); }
+
+/// Propagates the solver over samples [begin, end) in steps of nGroup samples
+/// (the strain or stress at the end of the group, the sum of the time steps).
+/// nGroup = 1 is the fine propagator and stores the outputs in out (optional),
+/// nGroup > 1 the coarse one;
+template<class Solver>
+static rope::ErrorCode propagate(Solver& solver, double dataIn[], double dt[], int begin,
+    int end, int nGroup, double out[])
+{
+    for (int j = begin; j < end; j += nGroup) {
+        int jEnd = min(j + nGroup, end);
+        double h = 0;
+        for (int i = j; i < jEnd; i++)
+            h += dt[i];
+
+        rope::ErrorCode err = solver.syncom_solver(setting, dataIn[jEnd - 1], h);
+        if (err != rope::ErrorCode::SUCCESS)
+            return err;
+        if (out)
+            out[j] = sample_output(solver);
+    }
+    return rope::ErrorCode::SUCCESS;
+}
+
+/// Parareal iteration over nSlices time slices. The boundary states are first
+/// estimated by a coarse sweep. Each iteration solves the slices with the fine
+/// propagator in parallel, starting from the current boundary states, and then
+/// corrects the boundary states sequentially:
+///     u(s+1) = G(u(s)) + F(u_old(s)) - G(u_old(s)),
+/// with the slow state of the solvers (the hereditary quantities, see
+/// get_slowState) as u. The fine solution of the first unconverged slice is
+/// exact, so the iteration ends after nSlices iterations at the latest, and
+/// earlier when the boundary states change by less than tol (relative);
+template<class Solver>
+static rope::ErrorCode run_parareal(Solver& solver, double dataIn[], double dt[], int nSteps,
+    int nSlices, int nCoarse, double tol, double out[], int& nIter)
+{
+    nSlices = max(1, min(nSlices, nSteps));
+    nCoarse = max(1, nCoarse);
+    vector<int> bound(nSlices + 1);
+    for (int s = 0; s <= nSlices; s++)
+        bound[s] = (int)((long long)nSteps * s / nSlices);
+
+    vector<Solver> U(nSlices + 1, solver), F(nSlices + 1, solver);
+    vector<vector<double> > u(nSlices + 1), g(nSlices + 1);
+    vector<double> gNew, f;
+    vector<rope::ErrorCode> errs(nSlices, rope::ErrorCode::SUCCESS);
+    rope::ErrorCode err;
+
+    // Coarse sweep;
+    for (int s = 0; s < nSlices; s++) {
+        U[s + 1] = U[s];
+        err = propagate(U[s + 1], dataIn, dt, bound[s], bound[s + 1], nCoarse, (double*)NULL);
+        if (err != rope::ErrorCode::SUCCESS)
+            return err;
+        U[s + 1].get_slowState(g[s + 1]);
+        u[s + 1] = g[s + 1];
+    }
+
+    int nThreads = max(1, (int)thread::hardware_concurrency());
+    int first = 0;      // the slices before first start from exact states;
+    nIter = 0;
+    while (first < nSlices) {
+        nIter++;
+
+        // Fine solutions of the slices, in parallel;
+        for (int s0 = first; s0 < nSlices; s0 += nThreads) {
+            vector<thread> workers;
+            for (int s = s0; s < min(s0 + nThreads, nSlices); s++)
+                workers.push_back(thread([&, s]() {
+                    F[s + 1] = U[s];
+                    errs[s] = propagate(F[s + 1], dataIn, dt, bound[s], bound[s + 1], 1, out);
+                }));
+            for (size_t w = 0; w < workers.size(); w++)
+                workers[w].join();
+        }
+        for (int s = first; s < nSlices; s++)
+            if (errs[s] != rope::ErrorCode::SUCCESS)
+                return errs[s];
+
+        // Corrects the boundary states; the change of each component is measured
+        // relative to its largest magnitude over the boundaries (the Prony states
+        // change sign);
+        U[first + 1] = F[first + 1];
+        vector<double> scale(u[nSlices].size(), setting.tol);
+        for (int s = first + 1; s <= nSlices; s++)
+            for (size_t i = 0; i < scale.size(); i++)
+                scale[i] = max(scale[i], abs(u[s][i]));
+        double change = 0;
+        for (int s = first + 1; s < nSlices; s++) {
+            Solver coarse = U[s];
+            err = propagate(coarse, dataIn, dt, bound[s], bound[s + 1], nCoarse, (double*)NULL);
+            if (err != rope::ErrorCode::SUCCESS)
+                return err;
+            coarse.get_slowState(gNew);
+            F[s + 1].get_slowState(f);
+            for (size_t i = 0; i < f.size(); i++)
+                f[i] = gNew[i] + f[i] - g[s + 1][i];
+
+            for (size_t i = 0; i < f.size(); i++)
+                change = max(change, abs(f[i] - u[s + 1][i]) / scale[i]);
+            g[s + 1] = gNew;
+            u[s + 1] = f;
+            U[s + 1] = F[s + 1];
+            U[s + 1].set_slowState(f, 0);
+        }
+        first++;
+        if (change <= tol)
+            break;
+    }
+
+    solver = F[nSlices];
+    return rope::ErrorCode::SUCCESS;
+}
+
+int DECLDIR SynCOM_parareal(double dataIn[], double dt[], int nSteps, int nSlices,
+    int nCoarse, double tol, double out[], int* nIter)
+{
+    int nIt = 0;
+    if (nSteps <= 0)
+        errCodes = rope::ErrorCode::SUCCESS;
+    else if (setting.module == 0)
+        errCodes = run_parareal(strainOutput, dataIn, dt, nSteps, nSlices, nCoarse, tol, out, nIt);
+    else
+        errCodes = run_parareal(stressOutput, dataIn, dt, nSteps, nSlices, nCoarse, tol, out, nIt);
+
+    if (nIter)
+        *nIter = nIt;
+
+    /// Check simulation end status.
+    if (errCodes != rope::ErrorCode::SUCCESS)
+    {
+        print_log(setting, errCodes, errorOut);
+        return 1;
+    }
+
+    return 0;
+}
+
 // End of main program
@@ -54,6 +54,40 @@ extern "C"
 
     // Extracts Stress result (latest time step ).
     double DECLDIR extract_sigma(void);
+
+    // Extracts Newton iterations of the stress solver (latest time step, 0 for module 1).
+    int DECLDIR extract_nIter(void);
+
+    // Cycle jumping - Solves nCycles repetitions of one loading cycle (nSteps samples of
+    // dataIn and dt). Once the cycle-to-cycle drift is steady, cycles are skipped by
+    // extrapolating the drifting state; tol bounds the relative extrapolation error.
+    // nSimulated returns the number of cycles actually simulated.
+    int DECLDIR SynCOM_cycles(double dataIn[], double dt[], int nSteps, int nCycles,
+        double tol, int* nSimulated);
+
+    // Time history with cycle jumping - Solves nSteps samples of dataIn and dt like repeated
+    // calls of SynCOM. Where a loading cycle of up to maxPeriod samples repeats (dataIn
+    // within matchTol of the load range, dt within matchTol relative), the repetitions are
+    // solved like SynCOM_cycles with tol. nSimulated returns the number of samples actually
+    // simulated.
+    int DECLDIR SynCOM_periodic(double dataIn[], double dt[], int nSteps, int maxPeriod,
+        double matchTol, double tol, int* nSimulated);
+
+    // Time history with hold fast-forward - Solves nSteps samples of dataIn and dt like
+    // repeated calls of SynCOM. Holds (runs of constant dataIn and dt) are advanced
+    // analytically (module 0) or with adaptive substeps whose relative stress change is
+    // bounded by tol (module 1, tol <= 0: step by step). out (optional) returns the strain
+    // (module 0) or stress (module 1) of each sample.
+    int DECLDIR SynCOM_history(double dataIn[], double dt[], int nSteps, double tol,
+        double out[]);
+
+    // Parallel-in-time (Parareal) solution - Solves nSteps samples of dataIn and dt split
+    // into nSlices time slices that are solved in parallel. A coarse sweep (steps of
+    // nCoarse samples) estimates the state at the slice boundaries; the iteration stops
+    // when the boundary states change by less than tol (relative). out (optional) returns
+    // the strain (module 0) or stress (module 1) of each sample; nIter the iterations.
+    int DECLDIR SynCOM_parareal(double dataIn[], double dt[], int nSteps, int nSlices,
+        int nCoarse, double tol, double out[], int* nIter);
 /*
     // Clear all global variables and close the program.
     int DECLDIR finish(void); */
@@ -51,6 +51,9 @@ namespace rope {
         case ErrorCode::BAD_DT_INPUT:
             return ("Negative dt detected.");
 
+        case ErrorCode::BAD_CYCLE_INPUT:
+            return ("Loading cycle must have at least one sample and be repeated at least once.");
+
         case ErrorCode::SETTING_FILE_NO_INPUT_DATA_FILE:
             return ("Cant find input data (stress or strain) file.");
 
@@ -42,6 +42,7 @@ namespace rope {
         NAN_INPUT_DATA,
         NEGATIVE_STRESS_INPUT,
         NEGATIVE_STRAIN_INPUT,
+        BAD_CYCLE_INPUT,
 
         /// Check Material Properties' Inputs in ReadIn.h.
         SETTING_FILE_NO_INPUT_DATA_FILE,
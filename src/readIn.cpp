@@ -345,6 +345,17 @@ namespace rope {
         // Clear parameters;
         names.clear();
 
+        // Initial stress guess of the Newton solve (optional; 0: previous stress trend,
+        // 1: tangent predictor, 2: tangent predictor with extrapolation in time);
+        setting.predictor = 0;
+        if (child_node->first_node("predictor") != 0) {
+            names.push_back("predictor");
+            if (!check_is_number(child_node, names))
+                return ErrorCode::SETTING_FILE_NAN_MATERIAL_PROPERTIES;
+            setting.predictor = stoi(child_node->first_node("predictor")->value());
+            names.clear();
+        }
+
         ////////////////////////////////////////////////////////////////////////////
         // Read input stress (strain) and time data from the specified file.
         ////////////////////////////////////////////////////////////////////////////
@@ -20,11 +20,49 @@
 #define setting_h
 
 #include "error.h"
+#include <math.h>
 #include <vector>
+#include <algorithm>
 #include <sstream>
 
 namespace rope {
 
+    ///////////////////////////////////////////////////////////////////////////////
+    /// Index of a material parameter defined with step functions: the stress
+    /// limits L(...) in a flat ascending array and the first coefficient of each
+    /// piece. Piece k holds lim[k - 1] < sigma <= lim[k] (piece 0: sigma <= lim[0],
+    /// last piece: sigma > lim[n - 1]);
+    ///////////////////////////////////////////////////////////////////////////////
+    struct StepIndex
+    {
+        std::vector<double> lim;    // stress limits;
+        std::vector<int> first;     // first coefficient of each piece, then the number of coefficients;
+
+        void build(const std::vector<std::vector<double>>& stress_lim, int step_num, size_t nCoefs) {
+            lim.clear();
+            first.assign(1, 0);
+            for (int i = 0; i < step_num; i++) {
+                lim.push_back(stress_lim[0][i]);
+                first.push_back((int)stress_lim[1][i]);
+            }
+            first.push_back((int)nCoefs);
+        }
+
+        /// Returns the piece holding sigma (-1 for NaN). hint is the piece found by the
+        /// previous call; it is checked first since sigma rarely changes piece between
+        /// Newton iterations, otherwise the limits are binary searched;
+        int find(double sigma, int& hint) const {
+            int n = (int)lim.size();
+            if (hint >= 0 && hint <= n && (hint == 0 || lim[hint - 1] < sigma)
+                && (hint == n || sigma <= lim[hint]))
+                return hint;
+            if (isnan(sigma))
+                return -1;
+            hint = (int)(std::lower_bound(lim.begin(), lim.end(), sigma) - lim.begin());
+            return hint;
+        }
+    };
+
     struct MatProps
     {
         /// Material properties 
@@ -104,7 +142,7 @@ namespace rope {
 #endif
 
         /// Module selection, time and Stress/Strain input data;
-        int limit, module;
+        int limit, module, predictor;
         double tol;
         std::vector<double> dt;
         std::vector<std::vector<double>> dataIn;
@@ -260,6 +260,116 @@ namespace rope {
 
     } // End of syncom_solver
 
+    ///////////////////////////////////////////////////////////////////////////////
+    /// Slow state for cycle jumping: the quantities that drift from one loading
+    /// cycle to the next (eps_vp, sigma_yield, te, qnim1). set_slowState keeps
+    /// eps_vp and te non-negative (the state may be extrapolated) and advances
+    /// the simulation time by dtime (the skipped cycles);
+    //////////////////////////////////////////////////////////////////////////////
+    void strainSolver::get_slowState(vector<double>& state) {
+
+        state.assign(1, eps_vp);
+        state.push_back(sigma_yield);
+        state.push_back(te);
+        state.insert(state.end(), qnim1.begin(), qnim1.end());
+    }
+
+    void strainSolver::set_slowState(const vector<double>& state, double dtime) {
+
+        eps_vp = max(state[0], 0.0);
+        sigma_yield = state[1];
+        te = max(state[2], 0.0);
+        for (size_t i = 0; i < qnim1.size(); i++)
+            qnim1[i] = state[3 + i];
+
+        eps = eps_ve + eps_vp;
+        simTime = simTime + dtime;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////
+    /// Fast-forward through a hold: nSteps samples of constant stress dataIn and
+    /// time step dt. The first sample is solved as usual; afterwards the
+    /// coefficients, dPsy and g2 * sigma stay constant, so qnim1 only decays by
+    /// exp(-lamdaN*dPsy) per sample and the visco-plastic rate by
+    /// exp(-H_vp/np*dt). With out, the strain of each sample is evaluated from
+    /// these factors (same values as the step by step solution); without out,
+    /// the state is advanced to the end of the hold in closed form;
+    //////////////////////////////////////////////////////////////////////////////
+    ErrorCode strainSolver::hold(Setting& setting, double dataIn, double dt, int nSteps,
+        double out[]) {
+
+        ErrorCode errCode = syncom_solver(setting, dataIn, dt);
+        if (errCode != ErrorCode::SUCCESS || nSteps <= 1) {
+            if (out && errCode == ErrorCode::SUCCESS) out[0] = eps;
+            return errCode;
+        }
+        if (out) out[0] = eps;
+
+        /// Constant factors of the hold;
+        size_t nProny = setting.material_props->lamdaN.size();
+        vector<double> decay(nProny);
+        sumDn2 = 0;
+        for (size_t i1 = 0; i1 < nProny; i1++) {
+            decay[i1] = exp(-setting.material_props->lamdaN[i1] * dPsy);
+            sumDn2 = sumDn2 + setting.material_props->Dn[i1] *
+                (1 - decay[i1]) / (setting.material_props->lamdaN[i1] * dPsy);
+        }
+        bool vp = (dataIn - sigma_yield) > setting.tol;
+        int nRest = nSteps - 1;
+
+        if (out) {
+            /// Sample by sample evaluation;
+            for (int k = 1; k <= nRest; k++) {
+                sumDn1 = 0;
+                for (size_t i1 = 0; i1 < nProny; i1++)
+                    sumDn1 = sumDn1 + setting.material_props->Dn[i1] * decay[i1] * qnim1[i1];
+                Btemp = g1 * sumDn1 - g1 * g2im1 * sigmaim1 * sumDn2;
+                eps_ve = Atemp * dataIn - Btemp;
+
+                if (vp) {
+                    te = te + dt;
+                    integrateSR(setting, dataIn, dt);
+                    eps_vp = eps_vp + eps_vp_inc;
+                }
+                eps = eps_ve + eps_vp;
+                simTime = simTime + dt;
+                out[k] = eps;
+
+                for (size_t i1 = 0; i1 < nProny; i1++)
+                    qnim1[i1] = decay[i1] * qnim1[i1];
+            }
+        }
+        else {
+            /// Closed form: qnim1 decays over nRest samples; eps_ve is evaluated
+            /// with qnim1 of the last sample;
+            sumDn1 = 0;
+            for (size_t i1 = 0; i1 < nProny; i1++) {
+                qnim1[i1] = exp(-setting.material_props->lamdaN[i1] * dPsy * (nRest - 1)) * qnim1[i1];
+                sumDn1 = sumDn1 + setting.material_props->Dn[i1] * decay[i1] * qnim1[i1];
+                qnim1[i1] = decay[i1] * qnim1[i1];
+            }
+            Btemp = g1 * sumDn1 - g1 * g2im1 * sigmaim1 * sumDn2;
+            eps_ve = Atemp * dataIn - Btemp;
+
+            // Geometric sum of the visco-plastic increments at te + dt, ..., te + nRest * dt;
+            if (vp) {
+                double c = H_vp / np;
+                double sum = (c * dt == 0) ? nRest :
+                    exp(-c * dt) * expm1(-c * dt * nRest) / expm1(-c * dt);
+                eps_vp = eps_vp + (dataIn - setting.material_props->sigma_yield0) /
+                    np * exp(-c * te) * dt * sum;
+                te = te + nRest * dt;
+            }
+            eps = eps_ve + eps_vp;
+            simTime = simTime + nRest * dt;
+        }
+
+        if (isnan(eps))
+            return ErrorCode::NAN_OUTPUT;
+
+        return ErrorCode::SUCCESS;
+    }
+
 } // End of namespace rope.
 
 
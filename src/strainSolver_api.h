@@ -58,6 +58,13 @@ namespace rope {
         double get_eps_ve(void) { return eps_ve; };
         double get_eps_vp(void) { return eps_vp; };
 
+        // Cycle jumping (SynCOM_cycles): state drifting from cycle to cycle;
+        void get_slowState(vector<double>& state);
+        void set_slowState(const vector<double>& state, double dtime);
+
+        // Hold fast-forward (SynCOM_history): nSteps samples of constant stress;
+        ErrorCode hold(Setting& setting, double dataIn, double dt, int nSteps, double out[]);
+
     };
 
 } // End of namespace rope.
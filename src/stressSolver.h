@@ -31,32 +31,38 @@ namespace rope {
     class stressSolver {
 
         double a0, g0, g1, g2, Ep, np, H_vp,
-               da0, dg0, dg1, dg2, dEp, dEpm1,  // 1st derivative WRT sigma (applied stress)
-               dnp, dnpm1, dH_vp, d2a0, d2g0,   // 2nd derivative WRT sigma (applied stress)
-               d2g1, d2g2, d2Ep, d2np, d2H_vp;  
+               da0, dg0, dg1, dg2, dEp,         // 1st derivative WRT sigma (applied stress)
+               dnp, dH_vp;
 
-        double te, dPsy, d2Psy, d3Psy, Func, DFunc,
+        double te, dPsy, Func, DFunc,
                epsim1, sigmaim1, sigmaim2, g2im1;
 
+        double stiff;   // tangent stiffness of the last converged solution (0 = none);
+
         int mode, iter, flag;
 
         // Temporary variables;
-        double jtemp, err, stemp, stemp_new, sumDn1, sumDn2, sumDn3, 
-               sumDn4, Exp3, Atemp, Btemp, dAtemp, dBtemp, 
-               dCtemp, dExp1, dExp2, dExp3, eps_vp_temp;
+        double err, stemp, stemp_new, sumDn1, sumDn2, 
+               Atemp, Btemp, eps_vp_temp;
+
+        // Step functions: index of each material parameter (a0, g0, g1, g2, Ep, np, H)
+        // and the piece last found;
+        StepIndex stepIndex[7];
+        int step_hint[7];
 
         vector<double> qn;
         vector<double> qnim1;
 
         int calCoeffs(Setting& setting, double sigma, double dt);
-        int calCoeffs_step(int step_num, double sigma,
-            std::vector<std::vector<double>>& stress_lim,
-            std::vector<double>& xyzCoefs,
-            double& xyz, double& dxyz, double& d2xyz);
+        void calPoly(std::vector<double>& xyzCoefs, int begin, int end,
+            double sigma, double& xyz, double& dxyz);
+        int calCoeffs_step(const StepIndex& steps, int& hint, double sigma,
+            std::vector<double>& xyzCoefs, double& xyz, double& dxyz);
         void calCoeffs_nostep(std::vector<double>& xyzCoefs, double& xyz,
-            double& dxyz, double& d2xyz, double sigma);
+            double& dxyz, double sigma);
         void calDFunc(int mode, Setting& setting, double sigma, double dt);
         void calQn(Setting& setting, double sigma);
+        double predict(Setting& setting, int i);
 
     public:
         stressSolver(Setting& setting);
@@ -67,6 +73,7 @@ namespace rope {
         vector<double> eps_vp;
         vector<double> eps_ve;
         vector<double> sigma_cal;
+        long nIter;     // total number of Newton iterations;
     };
 
 } // End of namespace rope.
@@ -16,6 +16,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "stressSolver_api.h"
+#include "dualNumber.h"
 
 namespace rope {
     ///////////////////////////////////////////////////////////////////////////////
@@ -26,60 +27,52 @@ namespace rope {
         // Initializes zero variables and zero vectors;
         a0 = g0 = g1 = g2 = Ep = np = H_vp = 0;
         da0 = dg0 = dg1 = dg2 = dEp = dnp = dH_vp = 0;
-        d2a0 = d2g0 = d2g1 = d2g2 = d2Ep = d2np = d2H_vp = 0;
-        te = dPsy = d2Psy = d3Psy = sigmaim1 = sigmaim2 = 0;
-        epsim1 = 0;
+        te = dPsy = sigmaim1 = sigmaim2 = 0;
+        epsim1 = epsim2 = stiff = 0;
+        nIter = 0;
         g2im1 = 1; sigma_yield = setting.material_props->sigma_yield0;
 
+        // Step function index of each material parameter and the piece last found;
+        stepIndex[0].build(setting.material_props->a0stress_lim, setting.material_props->step_num[0], setting.material_props->a0Coefs.size());
+        stepIndex[1].build(setting.material_props->g0stress_lim, setting.material_props->step_num[1], setting.material_props->g0Coefs.size());
+        stepIndex[2].build(setting.material_props->g1stress_lim, setting.material_props->step_num[2], setting.material_props->g1Coefs.size());
+        stepIndex[3].build(setting.material_props->g2stress_lim, setting.material_props->step_num[3], setting.material_props->g2Coefs.size());
+        stepIndex[4].build(setting.material_props->Epstress_lim, setting.material_props->step_num[4], setting.material_props->EpCoefs.size());
+        stepIndex[5].build(setting.material_props->npstress_lim, setting.material_props->step_num[5], setting.material_props->npCoefs.size());
+        stepIndex[6].build(setting.material_props->Hstress_lim, setting.material_props->step_num[6], setting.material_props->H_vpCoefs.size());
+        for (int k = 0; k < 7; k++)
+            step_hint[k] = 0;
+
         qn.resize(setting.material_props->lamdaN.size());
         qnim1.resize(setting.material_props->lamdaN.size());
 
         simTime = sigma_cal = eps_In = eps_vp = eps_ve = 0;
     }
 
+    ///////////////////////////////////////////////////////////////////////////////
+    /// Evaluates one polynomial piece of a material parameter and its derivative
+    /// WRT sigma in the same Horner pass;
+    ///////////////////////////////////////////////////////////////////////////////
+    void stressSolver::calPoly(std::vector<double>& xyzCoefs, int begin, int end,
+        double sigma, double& xyz, double& dxyz) {
+
+        Dual p = horner(xyzCoefs, begin, end, Dual(sigma, 1));
+        xyz = p.v; dxyz = p.d;
+    }
+
     ///////////////////////////////////////////////////////////////////////////////
     /// Evaluates the material parameters from the input polynomial coefficients;
     /// a0, g0, g1, g2, Ep, np, H; With Step Functions;
     ///////////////////////////////////////////////////////////////////////////////
-    int stressSolver::calCoeffs_step(int step_num, double sigma,
-        std::vector<std::vector<double>>& stress_lim, std::vector<double>& xyzCoefs,
-        double& xyz, double& dxyz, double& d2xyz) {
-
-        for (int i = 0; i < step_num; i++) {
-            if (i == 0 && sigma <= stress_lim[0][i]) {
-                for (int j = 0; j < stress_lim[1][i]; j++) {
-                    xyz += xyzCoefs[j] * pow(sigma, j);
-                    if (j > 0)
-                        dxyz += xyzCoefs[j] * j * pow(sigma, j - 1);
-                    if (j > 1)
-                        d2xyz += xyzCoefs[j] * j * (j - 1) * pow(sigma, j - 2);
-                }
-                return 0; // Success
-            }
-            else if (i == (step_num - 1) && sigma > stress_lim[0][i]) {
-                for (int j = stress_lim[1][i]; j < xyzCoefs.size(); j++) {
-                    jtemp = j - stress_lim[1][i];
-                    xyz += xyzCoefs[j] * pow(sigma, jtemp);
-                    if (jtemp > 0)
-                        dxyz += xyzCoefs[j] * jtemp * pow(sigma, jtemp - 1);
-                    if (jtemp > 1)
-                        d2xyz += xyzCoefs[j] * jtemp * (jtemp - 1) * pow(sigma, jtemp - 2);
-                }
-                return 0; // Success
-            }
-            else if (sigma > stress_lim[0][i] && sigma <= stress_lim[0][i + 1]) {
-                for (int j = stress_lim[1][i]; j < stress_lim[1][i + 1]; j++) {
-                    jtemp = j - stress_lim[1][i];
-                    xyz += xyzCoefs[j] * pow(sigma, jtemp);
-                    if (jtemp > 0)
-                        dxyz += xyzCoefs[j] * jtemp * pow(sigma, jtemp - 1);
-                    if (jtemp > 1)
-                        d2xyz += xyzCoefs[j] * jtemp * (jtemp - 1) * pow(sigma, jtemp - 2);
-                }
-                return 0; // Success
-            }
-        }
-        return 1; // Failed to find step limits;
+    int stressSolver::calCoeffs_step(const StepIndex& steps, int& hint, double sigma,
+        std::vector<double>& xyzCoefs, double& xyz, double& dxyz) {
+
+        int k = steps.find(sigma, hint);
+        if (k < 0)
+            return 1; // Failed to find step limits;
+
+        calPoly(xyzCoefs, steps.first[k], steps.first[k + 1], sigma, xyz, dxyz);
+        return 0; // Success
     }
 
     ///////////////////////////////////////////////////////////////////////////////
@@ -87,181 +80,136 @@ namespace rope {
     /// a0, g0, g1, g2, Ep, np, H; No Step Function;
     ///////////////////////////////////////////////////////////////////////////////
     void stressSolver::calCoeffs_nostep(std::vector<double>& xyzCoefs, double& xyz,
-        double& dxyz, double& d2xyz, double sigma) {
-
-        for (int i = 0; i < xyzCoefs.size(); i++) {
-            xyz += xyzCoefs[i] * pow(sigma, i);
-            if (i > 0)
-                dxyz += xyzCoefs[i] * i * pow(sigma, i - 1);
-            if (i > 1)
-                d2xyz += xyzCoefs[i] * i * (i - 1) * pow(sigma, i - 2);
-        }
+        double& dxyz, double sigma) {
+
+        calPoly(xyzCoefs, 0, (int)xyzCoefs.size(), sigma, xyz, dxyz);
     }
 
     ///////////////////////////////////////////////////////////////////////////////
     /// Evaluates the material parameters from the input polynomial coefficients;
-    /// a0, g0, g1, g2, Ep, np, H;
+    /// a0, g0, g1, g2, Ep, np, H, and their first derivatives;
     ///////////////////////////////////////////////////////////////////////////////
     int stressSolver::calCoeffs(Setting& setting, double sigma, double dt) {
 
         /// Reset values of a0, g0, g1, g2, Ep, np, H_vp, and their derivatives;
         a0 = g0 = g1 = g2 = Ep = np = H_vp = 0;
-        da0 = dg0 = dg1 = dg2 = dEp = dnp = dH_vp = 0;
-        d2a0 = d2g0 = d2g1 = d2g2 = d2Ep = d2np = d2H_vp = flag = 0;
+        da0 = dg0 = dg1 = dg2 = dEp = dnp = dH_vp = flag = 0;
 
         /// Calculate a0, g0, g1, g2, Ep, np, H_vp, and their derivatives;
         if (setting.material_props->step_num[0] == 0) {
-            calCoeffs_nostep(setting.material_props->a0Coefs, a0, da0, d2a0, sigma);
+            calCoeffs_nostep(setting.material_props->a0Coefs, a0, da0, sigma);
         }
         else {
-            flag = calCoeffs_step(setting.material_props->step_num[0], sigma,
-                setting.material_props->a0stress_lim,
-                setting.material_props->a0Coefs, a0, da0, d2a0);
+            flag = calCoeffs_step(stepIndex[0], step_hint[0], sigma,
+                setting.material_props->a0Coefs, a0, da0);
         }
         if (flag) return flag;
 
         if (setting.material_props->step_num[1] == 0) {
-            calCoeffs_nostep(setting.material_props->g0Coefs, g0, dg0, d2g0, sigma);
+            calCoeffs_nostep(setting.material_props->g0Coefs, g0, dg0, sigma);
         }
         else {
-            flag = calCoeffs_step(setting.material_props->step_num[1], sigma, 
-                setting.material_props->g0stress_lim,
-                setting.material_props->g0Coefs, g0, dg0, d2g0);
+            flag = calCoeffs_step(stepIndex[1], step_hint[1], sigma,
+                setting.material_props->g0Coefs, g0, dg0);
         }
         if (flag) return flag;
 
         if (setting.material_props->step_num[2] == 0) {
-            calCoeffs_nostep(setting.material_props->g1Coefs, g1, dg1, d2g1, sigma);
+            calCoeffs_nostep(setting.material_props->g1Coefs, g1, dg1, sigma);
         }
         else {
-            flag = calCoeffs_step(setting.material_props->step_num[2], sigma, 
-                setting.material_props->g1stress_lim,
-                setting.material_props->g1Coefs, g1, dg1, d2g1);
+            flag = calCoeffs_step(stepIndex[2], step_hint[2], sigma,
+                setting.material_props->g1Coefs, g1, dg1);
         }
         if (flag) return flag;
 
         if (setting.material_props->step_num[3] == 0) {
-            calCoeffs_nostep(setting.material_props->g2Coefs, g2, dg2, d2g2, sigma);
+            calCoeffs_nostep(setting.material_props->g2Coefs, g2, dg2, sigma);
         }
         else {
-            flag = calCoeffs_step(setting.material_props->step_num[3], sigma, 
-                setting.material_props->g2stress_lim,
-                setting.material_props->g2Coefs, g2, dg2, d2g2);
+            flag = calCoeffs_step(stepIndex[3], step_hint[3], sigma,
+                setting.material_props->g2Coefs, g2, dg2);
         }
         if (flag) return flag;
 
         if (setting.material_props->step_num[4] == 0) {
-            calCoeffs_nostep(setting.material_props->EpCoefs, Ep, dEp, d2Ep, sigma);
+            calCoeffs_nostep(setting.material_props->EpCoefs, Ep, dEp, sigma);
         }
         else {
-            flag = calCoeffs_step(setting.material_props->step_num[4], sigma, 
-                setting.material_props->Epstress_lim,
-                setting.material_props->EpCoefs, Ep, dEp, d2Ep);
+            flag = calCoeffs_step(stepIndex[4], step_hint[4], sigma,
+                setting.material_props->EpCoefs, Ep, dEp);
         }
         if (flag) return flag;
 
         if (setting.material_props->step_num[5] == 0) {
-            calCoeffs_nostep(setting.material_props->npCoefs, np, dnp, d2np, sigma);
+            calCoeffs_nostep(setting.material_props->npCoefs, np, dnp, sigma);
         }
         else {
-            flag = calCoeffs_step(setting.material_props->step_num[5], sigma, 
-                setting.material_props->npstress_lim,
-                setting.material_props->npCoefs, np, dnp, d2np);
+            flag = calCoeffs_step(stepIndex[5], step_hint[5], sigma,
+                setting.material_props->npCoefs, np, dnp);
         }
         if (flag) return flag;
 
         if (setting.material_props->step_num[6] == 0) {
-            calCoeffs_nostep(setting.material_props->H_vpCoefs, H_vp, dH_vp, d2H_vp, sigma);
+            calCoeffs_nostep(setting.material_props->H_vpCoefs, H_vp, dH_vp, sigma);
         }
         else {
-            flag = calCoeffs_step(setting.material_props->step_num[6], sigma, 
-                setting.material_props->Hstress_lim,
-                setting.material_props->H_vpCoefs, H_vp, dH_vp, d2H_vp);
+            flag = calCoeffs_step(stepIndex[6], step_hint[6], sigma,
+                setting.material_props->H_vpCoefs, H_vp, dH_vp);
         }
         if (flag) return flag;
 
         /// Calculates dPsy;
         dPsy = 1 / a0 * dt;
-        d2Psy = -pow(a0, -2) * da0 * dt;
-        d3Psy = (2 * pow(a0, -3) * da0 - pow(a0, -2) * d2a0) * da0 * dt;
-
-        /// Calculates dnpm1;
-        dnpm1 = -pow(np, -2) * dnp;
-
-        /// Calculates dEpm1;
-        dEpm1 = -pow(Ep, -2) * dEp;
         return 0;
     }
 
     ///////////////////////////////////////////////////////////////////////////////
     /// Calculates function's derivatives for Newton-Raphson method;
+    /// The derivative of Func = eps - A - B - C WRT sigma is obtained by forward-mode
+    /// differentiation of the same expressions (see dualNumber.h);
     ///////////////////////////////////////////////////////////////////////////////
     void stressSolver::calDFunc(int mode, Setting& setting, double sigma, double dt) {
 
+        Dual s(sigma, 1), Psy = 1 / Dual(a0, da0) * dt;
+        Dual g0d(g0, dg0), g1d(g1, dg1), g2d(g2, dg2);
+
         // Prepares summation terms for construction of Visco-Elastic function;
-        sumDn1 = 0; sumDn2 = 0; sumDn3 = 0; sumDn4 = 0;
+        Dual sum1 = 0.0, sum2 = 0.0;
         for (size_t i = 0; i < setting.material_props->lamdaN.size(); i++) {
+            Dual expN = exp(-setting.material_props->lamdaN[i] * Psy);
+
             // SumDn1
-            sumDn1 += setting.material_props->Dn[i] *
-                exp(-setting.material_props->lamdaN[i] * dPsy) *
-                qnim1[i];
+            sum1 = sum1 + setting.material_props->Dn[i] * expN * qnim1[i];
             
             // SumDn2
-            sumDn2 += (setting.material_props->Dn[i] *
-                (1 - exp(-setting.material_props->lamdaN[i] * dPsy)) /
-                (setting.material_props->lamdaN[i] * dPsy));
-
-            // SumDn3
-            dExp1 = -setting.material_props->lamdaN[i] * d2Psy * 
-                    exp(-setting.material_props->lamdaN[i] * dPsy);
-            sumDn3 += setting.material_props->Dn[i] * dExp1 * qnim1[i];
-
-            // SumDn4
-            dExp2 = d2Psy * exp(-setting.material_props->lamdaN[i] * dPsy) / dPsy +
-                (1 - exp(-setting.material_props->lamdaN[i] * dPsy)) /
-                setting.material_props->lamdaN[i] / dt * da0;
-            sumDn4 += setting.material_props->Dn[i] * dExp2;
+            sum2 = sum2 + (setting.material_props->Dn[i] * (1 - expN) /
+                (setting.material_props->lamdaN[i] * Psy));
         }
        
         // Calculates temporary Atemp and Btemp terms;
-        Atemp = g0 * setting.material_props->Do + g1 * g2 *
-            setting.material_props->sumDn - g1 * g2 * sumDn2;
-
-        Btemp = g1 * sumDn1 - g1 * g2im1 * sigmaim1 * sumDn2;
-        
-        dAtemp = setting.material_props->Do * dg0 + (dg1 * g2 + g1 * dg2) * 
-                    setting.material_props->sumDn - 
-                    (dg1 * g2 * sumDn2 + g1 * dg2 * sumDn2 + g1 * g2 * sumDn4);
+        Dual A = g0d * setting.material_props->Do + g1d * g2d *
+            setting.material_props->sumDn - g1d * g2d * sum2;
 
-        dBtemp = g1 * (sumDn3 - g2im1 * sigmaim1 * sumDn4) + 
-                    dg1 * (sumDn1 - g2im1 * sigmaim1 * sumDn2);
+        Dual B = g1d * sum1 - g1d * g2im1 * sigmaim1 * sum2;
 
-        // Prepares summation terms for Visco-Plastic function;
-        Exp3 = exp(-H_vp / np * te);
-        dExp3 = -te * (dH_vp / np + H_vp * dnpm1) * Exp3;
+        Dual F = -A * s + B;
 
-        // Calculates dCd term(Visco-Plastic model);
+        // Calculates C term(Visco-Plastic model);
         if (mode != 0) {
-            if (te == dt) {
-                dCtemp = 1 / Ep + sigma * dEpm1 + 
-                            dt * (1 / np * Exp3 + sigma * 
-                                    dnpm1 * Exp3 + sigma * 1 / np * dExp3) - 
-                            dt * setting.material_props->sigma_yield0 * 
-                            (dnpm1 * Exp3 + 1 / np * dExp3);
-            }
-            else {
-                dCtemp = dt * (1 / np * Exp3 + sigma * 
-                            dnpm1 * Exp3 + sigma * 1 / np * dExp3) -
-                         dt * setting.material_props->sigma_yield0 * 
-                         (dnpm1 * Exp3 + 1 / np * dExp3);
-            }
-        }
-        else {
-            dCtemp = 0;
+            Dual npd(np, dnp);
+            Dual C = dt * (s - setting.material_props->sigma_yield0) / npd * 
+                        exp(-Dual(H_vp, dH_vp) / npd * te);
+            if (te == dt)
+                C = C + s / Dual(Ep, dEp);
+            F = F - C;
         }
-        
+
+        sumDn1 = sum1.v; sumDn2 = sum2.v;
+        Atemp = A.v; Btemp = B.v;
+
         // Calculates DFunc with func = eps - A - B - C;
-            DFunc = -Atemp - dAtemp * sigma + dBtemp - dCtemp;
+        DFunc = F.d;
     }
 
     ///////////////////////////////////////////////////////////////////////////////
@@ -277,6 +225,31 @@ namespace rope {
         }
     }
 
+    ///////////////////////////////////////////////////////////////////////////////
+    /// Initial stress guess of the visco-elastic Newton solve;
+    ///////////////////////////////////////////////////////////////////////////////
+    double stressSolver::predict(Setting& setting, double dataIn) {
+
+        // Tangent predictor: previous stress plus the strain increment times the tangent
+        // stiffness of the previous solution. Mode 2 extrapolates the stress in time and
+        // corrects the extrapolation with the tangent for the change of the strain increment;
+        if (setting.predictor > 0 && stiff > 0) {
+            double spred;
+            if (setting.predictor == 1)
+                spred = sigmaim1 + stiff * (dataIn - epsim1);
+            else
+                spred = 2 * sigmaim1 - sigmaim2 + stiff * ((dataIn - epsim1) - (epsim1 - epsim2));
+            if (spred > 0 && !isnan(spred))
+                return spred;
+        }
+
+        // Predicts little change in stresses;
+        if (abs(sigmaim1 - sigmaim2) < setting.tol)
+            return sigmaim1;
+        else
+            return 2 * sigmaim1 - sigmaim2;
+    }
+
     ///////////////////////////////////////////////////////////////////////////////
     /// SYNCOM - Module 2: Evaluates time history of material behaviors. 
     /// Input: time history of strain (deformation). Output: applying stress.
@@ -290,6 +263,7 @@ namespace rope {
         if (dt <= 0)
             return ErrorCode::BAD_DT_INPUT;
 
+        nIter = 0;
         if (dataIn == 0) {
             eps_vp = eps_vp;
             stemp_new = 0;
@@ -299,11 +273,7 @@ namespace rope {
                 err = 1; iter = 1; mode = 0;
 
                 // Guesses initial value of stress;
-                // Predicts little change in stresses;
-                if (abs(sigmaim1 - sigmaim2) < setting.tol)
-                    stemp = sigmaim1;
-                else
-                    stemp = 2 * sigmaim1 - sigmaim2;
+                stemp = predict(setting, dataIn);
 
                 // Solve for stress iteratively using Visco-Elastic model only;
                 while (abs(err) >= setting.tol && iter < setting.limit) {
@@ -335,7 +305,7 @@ namespace rope {
                         err = 0; iter = 1;
                     }
 
-                    iter = iter + 1;
+                    iter = iter + 1; nIter++;
                 }
             }
             else {
@@ -395,7 +365,7 @@ namespace rope {
                     else
                         stemp = stemp_new;
 
-                    iter = iter + 1;
+                    iter = iter + 1; nIter++;
                 }
 
                 if (!isnan(stemp)) {
@@ -432,7 +402,9 @@ namespace rope {
         calQn(setting, sigma_cal);  // updates qnim1
         sigmaim2 = sigmaim1;
         sigmaim1 = sigma_cal;
+        epsim2 = epsim1;
         epsim1 = dataIn;
+        stiff = (nIter > 0 && DFunc < 0) ? -1 / DFunc : 0;
         g2im1 = g2;
 
         simTime = simTime + dt;
@@ -443,6 +415,84 @@ namespace rope {
 
     } // End of syncom_solver.
      
+    ///////////////////////////////////////////////////////////////////////////////
+    /// Slow state for cycle jumping: the quantities that drift from one loading
+    /// cycle to the next (eps_vp, sigma_yield, te, the stress and g2 closing the
+    /// cycle, qnim1). The stress relaxes with qnim1 under a repeated strain
+    /// cycle, so it is part of the state entering the next hereditary update.
+    /// set_slowState keeps eps_vp, te, the stress and g2 non-negative (the
+    /// state may be extrapolated) and advances the simulation time by dtime
+    /// (the skipped cycles);
+    //////////////////////////////////////////////////////////////////////////////
+    void stressSolver::get_slowState(vector<double>& state) {
+
+        state.assign(1, eps_vp);
+        state.push_back(sigma_yield);
+        state.push_back(te);
+        state.push_back(sigmaim1);
+        state.push_back(g2im1);
+        state.insert(state.end(), qnim1.begin(), qnim1.end());
+    }
+
+    void stressSolver::set_slowState(const vector<double>& state, double dtime) {
+
+        eps_vp = max(state[0], 0.0);
+        sigma_yield = state[1];
+        te = max(state[2], 0.0);
+        sigmaim2 = sigmaim2 + max(state[3], 0.0) - sigmaim1;
+        sigmaim1 = sigma_cal = max(state[3], 0.0);
+        g2im1 = max(state[4], 0.0);
+        for (size_t i = 0; i < qnim1.size(); i++)
+            qnim1[i] = state[5 + i];
+
+        eps_ve = eps_In - eps_vp;
+        simTime = simTime + dtime;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////
+    /// Fast-forward through a hold: nSteps samples of constant strain dataIn and
+    /// time step dt. The stress relaxes with a nonlinear Newton solve per step,
+    /// so the hold is solved with substeps of m samples: m is doubled while a
+    /// substep changes the stress by less than tol (relative) and halved
+    /// otherwise. The stress of the samples inside a substep is interpolated
+    /// linearly. The first two samples (loading step, te and sigma_yield
+    /// updates) and the samples with te > 0 are solved step by step; tol <= 0
+    /// solves the whole hold step by step;
+    //////////////////////////////////////////////////////////////////////////////
+    ErrorCode stressSolver::hold(Setting& setting, double dataIn, double dt, int nSteps,
+        double tol, double out[]) {
+
+        ErrorCode errCode;
+        int k = 0, m = 1;
+        while (k < nSteps) {
+            if (k < 2 || te != 0 || tol <= 0) {
+                errCode = syncom_solver(setting, dataIn, dt);
+                if (errCode != ErrorCode::SUCCESS)
+                    return errCode;
+                if (out) out[k] = sigma_cal;
+                k++;
+                continue;
+            }
+
+            m = min(m, nSteps - k);
+            double s0 = sigma_cal;
+            errCode = syncom_solver(setting, dataIn, m * dt);
+            if (errCode != ErrorCode::SUCCESS)
+                return errCode;
+            if (out)
+                for (int j = 1; j <= m; j++)
+                    out[k + j - 1] = s0 + (sigma_cal - s0) * j / m;
+            k += m;
+
+            if (abs(sigma_cal - s0) <= tol * abs(sigma_cal))
+                m = 2 * m;
+            else
+                m = max(m / 2, 1);
+        }
+
+        return ErrorCode::SUCCESS;
+    }
+
 } // End of namespace rope.
 
 